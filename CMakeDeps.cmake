@@ -130,6 +130,22 @@ target_link_libraries(tiny_vulkan PUBLIC
 )
 
 
+# ------------------------------------
+# SPIRV-Reflect library via FetchContent
+# ------------------------------------
+set(SPIRV_REFLECT_EXECUTABLE OFF CACHE BOOL "" FORCE)
+set(SPIRV_REFLECT_EXAMPLES OFF CACHE BOOL "" FORCE)
+set(SPIRV_REFLECT_STATIC_LIB ON CACHE BOOL "" FORCE)
+FetchContent_Declare(
+  spirv_reflect
+  URL https://github.com/KhronosGroup/SPIRV-Reflect/archive/refs/tags/vulkan-sdk-1.4.304.0.tar.gz
+)
+FetchContent_MakeAvailable(spirv_reflect)
+target_link_libraries(tiny_vulkan PUBLIC 
+	spirv-reflect-static
+)
+
+
 # Finish
 # Puts deps in Folder CMakeDeps in IDE
 function(group_third_party target_name)
@@ -145,4 +161,5 @@ group_third_party(spdlog)
 group_third_party(vk-bootstrap)
 group_third_party(glm)
 group_third_party(vma)
-group_third_party(fastgltf)
\ No newline at end of file
+group_third_party(fastgltf)
+group_third_party(spirv-reflect-static)
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "Application.h"
 #include "VulkanCore.h"
 #include "CommandsExecutor.h"
+#include "AsyncCompute.h"
+#include "PipelineRegistry.h"
 #include "LifetimeManager.h"
 #include "LogSystem.h"
 
@@ -9,16 +11,24 @@ namespace tiny_vulkan {
 	Application* Application::s_AppInstance = nullptr;
 
 	Application::Application(const ApplicationSpec& appSpec)
+		: m_Spec(appSpec)
 	{
 		s_AppInstance = this;
 
 		LogSystem::Initialize();
 
-		m_Window = std::make_shared<Window>(appSpec.windowWidth, appSpec.windowHeight, appSpec.windowName);
-
-		VulkanCore::Initialize(m_Window);
+		if (appSpec.headless)
+		{
+			VulkanCore::InitializeHeadless(VkExtent2D{ appSpec.windowWidth, appSpec.windowHeight }, appSpec.renderSettings);
+		}
+		else
+		{
+			m_Window = std::make_shared<Window>(appSpec.windowWidth, appSpec.windowHeight, appSpec.windowName);
+			VulkanCore::Initialize(m_Window, appSpec.renderSettings);
+		}
 
 		CommandExecutor::Initialize();
+		AsyncCompute::Initialize();
 
 		m_Renderer = std::make_shared<VulkanRenderer>(m_Window);
 	}
@@ -26,17 +36,61 @@ namespace tiny_vulkan {
 	Application::~Application() 
 	{
 		LifetimeManager::ExecuteNow(vkDeviceWaitIdle, VulkanCore::GetDevice());
-		VulkanCore::GetSwapchain()->CleanupResources();
+		PipelineRegistry::LogStats();
+
+		// Scene resources retire themselves into the deletion queue, flushed by ExecuteAll
+		m_Renderer.reset();
+
+		if (VulkanCore::GetSwapchain())
+		{
+			VulkanCore::GetSwapchain()->CleanupResources();
+		}
 		LifetimeManager::ExecuteAll(); 
 	}
 
 	void Application::Run()
 	{
-		while (!m_Window->ShouldClose()) 
+		if (m_Spec.benchmarkPipelines)
+		{
+			m_Renderer->BenchmarkPipelines();
+			return;
+		}
+
+		if (!m_Window)
+		{
+			RunHeadless();
+			return;
+		}
+
+		// A frame count bounds windowed runs too, so configurations can be compared from scripts
+		for (uint32_t frame = 0; !m_Window->ShouldClose() && (m_Spec.frameCount == 0 || frame < m_Spec.frameCount); ++frame)
 		{
+			m_Renderer->WaitForPresent();
 			m_Window->OnUpdate();
 			m_Renderer->Draw();
 		}
 	}
 
+	void Application::RunHeadless()
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < m_Spec.frameCount; ++i)
+		{
+			m_Renderer->Draw();
+		}
+		LifetimeManager::ExecuteNow(vkDeviceWaitIdle, VulkanCore::GetDevice());
+
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		LOG_INFO(fmt::runtime("Headless run: {0} frames in {1:.1f} ms ({2:.3f} ms/frame)"),
+			m_Spec.frameCount,
+			elapsed.count(),
+			m_Spec.frameCount > 0 ? elapsed.count() / m_Spec.frameCount : 0.0
+		);
+
+		if (m_Spec.readbackPath && m_Spec.frameCount > 0)
+		{
+			m_Renderer->SaveRenderTarget(m_Spec.readbackPath);
+		}
+	}
+
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "Window.h"
 #include "VulkanRenderer.h"
+#include "VulkanCore.h"
 #include <memory>
 
 namespace tiny_vulkan {
@@ -11,6 +12,16 @@ namespace tiny_vulkan {
 		uint32_t windowWidth;
 		uint32_t windowHeight;
 		const char* windowName;
+		RenderSettings renderSettings;
+
+		// Headless: no window nor swapchain, renders frameCount frames offscreen at the window size then exits.
+		// The last frame is written to readbackPath (PPM) when set, for image diffs on CI (keep dynamic resolution off).
+		bool headless{ false };
+		uint32_t frameCount{ 0 };			// Windowed: exits after that many frames, 0 runs until the window closes
+		const char* readbackPath{ nullptr };
+
+		// Measures the pipeline backends on the scene material (PipelineBenchmark) instead of running frames
+		bool benchmarkPipelines{ false };
 	};
 
 	class Application 
@@ -22,12 +33,16 @@ namespace tiny_vulkan {
 		void Run();
 
 		static Application*				 GetRaw()			  { return s_AppInstance; }
-		std::shared_ptr<Window>			 GetWindow()	const { return m_Window; }
+		std::shared_ptr<Window>			 GetWindow()	const { return m_Window; }	// Null when headless
 		std::shared_ptr<VulkanRenderer>  GetRenderer()	const { return m_Renderer; }
 
+	private:
+		void RunHeadless();
+
 	private:
 		static Application*					s_AppInstance;
-		std::shared_ptr<Window>				m_Window;
+		ApplicationSpec						m_Spec;
+		std::shared_ptr<Window>				m_Window;			// Null when headless
 		std::shared_ptr<VulkanRenderer>     m_Renderer;
 	};
 }
\ No newline at end of file
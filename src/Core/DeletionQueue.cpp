@@ -0,0 +1,103 @@
+#include "DeletionQueue.h"
+
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace tiny_vulkan::DeletionQueue {
+
+	namespace {
+		struct Entry
+		{
+			uint64_t				frame{ 0 };
+			std::function<void()>	deleter;
+		};
+
+		// Internal linkage: accessible only within this translation unit.
+		std::mutex g_Mutex;
+		std::vector<Entry> g_Entries;	// Ordered by frame
+		uint64_t g_CurrentFrame = 1;
+
+		void Run(std::vector<Entry>& entries)
+		{
+			// Same order as LifetimeManager (LIFO), dependents are usually retired after their dependencies
+			for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+			{
+				if (it->deleter)
+				{
+					it->deleter();
+				}
+			}
+		}
+	}
+
+	void RegisterDeleter(std::function<void()>&& deleter)
+	{
+		std::lock_guard lock(g_Mutex);
+		g_Entries.push_back(Entry{ .frame = g_CurrentFrame, .deleter = std::move(deleter) });
+	}
+
+	void RegisterDeleterAt(uint64_t frame, std::function<void()>&& deleter)
+	{
+		std::lock_guard lock(g_Mutex);
+
+		// Usually the current frame or an earlier one: search from the back to keep the order
+		auto it = g_Entries.end();
+		while (it != g_Entries.begin() && std::prev(it)->frame > frame)
+		{
+			--it;
+		}
+		g_Entries.insert(it, Entry{ .frame = frame, .deleter = std::move(deleter) });
+	}
+
+	void SetCurrentFrame(uint64_t frame)
+	{
+		std::lock_guard lock(g_Mutex);
+		g_CurrentFrame = frame;
+	}
+
+	void Collect(uint64_t completedFrame)
+	{
+		std::vector<Entry> ready;
+		{
+			std::lock_guard lock(g_Mutex);
+
+			auto end = g_Entries.begin();
+			while (end != g_Entries.end() && end->frame <= completedFrame)
+			{
+				++end;
+			}
+
+			ready.assign(std::make_move_iterator(g_Entries.begin()), std::make_move_iterator(end));
+			g_Entries.erase(g_Entries.begin(), end);
+		}
+
+		// Outside the lock, a deleter may retire something else
+		Run(ready);
+	}
+
+	void FlushAll()
+	{
+		// A deleter may retire more (e.g. the last reference to an owner of other resources)
+		for (;;)
+		{
+			std::vector<Entry> entries;
+			{
+				std::lock_guard lock(g_Mutex);
+				entries.swap(g_Entries);
+			}
+
+			if (entries.empty())
+			{
+				return;
+			}
+			Run(entries);
+		}
+	}
+
+	size_t GetPendingCount()
+	{
+		std::lock_guard lock(g_Mutex);
+		return g_Entries.size();
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+#include <cstdint>
+
+// Deferred destruction of resources retired while the application runs.
+// Unlike LifetimeManager, deleters don't wait for shutdown: each one runs as soon as
+// the frame timeline reports complete the frame it was retired in, and so every submission before it.
+namespace tiny_vulkan::DeletionQueue {
+
+	template<typename F, typename... Args>
+	void PushFunction(F&& function, Args&&... args)
+	{
+		RegisterDeleter([func = std::forward<F>(function), ...args = std::forward<Args>(args)]()
+			{
+				std::invoke(func, args...);
+			});
+	}
+
+	// Runs once the frame timeline reaches frame, e.g. the value CommandExecutor::Submit returned.
+	template<typename F, typename... Args>
+	void PushFunctionAt(uint64_t frame, F&& function, Args&&... args)
+	{
+		RegisterDeleterAt(frame, [func = std::forward<F>(function), ...args = std::forward<Args>(args)]()
+			{
+				std::invoke(func, args...);
+			});
+	}
+
+	// Tagged with the current frame (see SetCurrentFrame). Safe to call from any thread.
+	void RegisterDeleter(std::function<void()>&& deleter);
+	void RegisterDeleterAt(uint64_t frame, std::function<void()>&& deleter);
+
+	/**
+	 * @brief Sets the frame new deleters are tagged with: the one whose submission signals next,
+	 * updated as soon as the previous one is submitted. Frame numbers start at 1.
+	 */
+	void SetCurrentFrame(uint64_t frame);
+
+	// Frame boundary: runs the deleters tagged up to completedFrame, the last frame the GPU finished (frame timeline value).
+	void Collect(uint64_t completedFrame);
+
+	// Shutdown, once the device is idle: runs every deleter left.
+	void FlushAll();
+
+	[[nodiscard]] size_t GetPendingCount();
+}
@@ -0,0 +1,85 @@
+#include "DestructorList.h"
+
+namespace tiny_vulkan {
+
+	DestructorList::DestructorList(size_t blockSize)
+		: m_BlockSize(blockSize)
+	{
+
+	}
+
+	DestructorList::~DestructorList()
+	{
+		Release(false);
+	}
+
+	void DestructorList::ExecuteAll()
+	{
+		Release(true);
+	}
+
+	std::byte* DestructorList::Allocate(size_t size)
+	{
+		if (m_Blocks.empty() || m_Blocks.back().capacity - m_Blocks.back().used < size)
+		{
+			// Oversized entries get a block of their own
+			Block block{};
+			block.capacity = std::max(m_BlockSize, size);
+			block.data = std::make_unique_for_overwrite<std::byte[]>(block.capacity);
+			block.last = NO_ENTRY;
+			m_Blocks.push_back(std::move(block));
+		}
+
+		auto& block = m_Blocks.back();
+		std::byte* memory = block.data.get() + block.used;
+
+		auto* header = ::new (static_cast<void*>(memory)) Header{};
+		header->size = static_cast<uint32_t>(size);
+		header->previous = block.last;
+
+		block.last = static_cast<uint32_t>(block.used);
+		block.used += size;
+		++m_Count;
+		return memory;
+	}
+
+	void DestructorList::Release(bool run)
+	{
+		// A deleter may push more entries, they land in a fresh list and are handled by the next pass
+		while (m_Count > 0)
+		{
+			std::vector<Block> blocks = std::move(m_Blocks);
+			m_Blocks.clear();
+			m_Count = 0;
+
+			// Newest block first, newest entry first within a block
+			for (auto block = blocks.rbegin(); block != blocks.rend(); ++block)
+			{
+				for (uint32_t offset = block->last; offset != NO_ENTRY; )
+				{
+					auto* header = reinterpret_cast<Header*>(block->data.get() + offset);
+					void* callable = block->data.get() + offset + sizeof(Header);
+					offset = header->previous;
+
+					if (run)
+					{
+						header->run(callable);
+					}
+					else
+					{
+						header->drop(callable);
+					}
+				}
+			}
+
+			// Keep one block around for the next registrations
+			if (m_Blocks.empty())
+			{
+				blocks.front().used = 0;
+				blocks.front().last = NO_ENTRY;
+				m_Blocks.push_back(std::move(blocks.front()));
+			}
+		}
+	}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tiny_vulkan {
+
+	/**
+	 * @brief LIFO list of deleters stored inline in bump-allocated blocks.
+	 * Each callable is placed right after a small header, no allocation per entry
+	 * (only when a block fills up). Not thread-safe.
+	 */
+	class DestructorList
+	{
+	public:
+		explicit DestructorList(size_t blockSize = 16 * 1024);
+		~DestructorList(); // Pending callables are destroyed without being run
+
+		DestructorList(const DestructorList&) = delete;
+		DestructorList& operator=(const DestructorList&) = delete;
+
+		template<typename F>
+		void Push(F&& function)
+		{
+			using Callable = std::decay_t<F>;
+			static_assert(alignof(Callable) <= alignof(std::max_align_t), "Over-aligned deleters are not supported");
+
+			std::byte* memory = Allocate(sizeof(Header) + AlignUp(sizeof(Callable)));
+			auto* header = reinterpret_cast<Header*>(memory);
+			header->run = [](void* callable)
+				{
+					auto* typed = static_cast<Callable*>(callable);
+					(*typed)();
+					typed->~Callable();
+				};
+			header->drop = [](void* callable)
+				{
+					static_cast<Callable*>(callable)->~Callable();
+				};
+			::new (static_cast<void*>(memory + sizeof(Header))) Callable(std::forward<F>(function));
+		}
+
+		// Runs every deleter, last pushed first, and empties the list (the first block is kept).
+		void ExecuteAll();
+
+		[[nodiscard]] size_t GetCount()		const { return m_Count; }
+		[[nodiscard]] bool	 IsEmpty()		const { return m_Count == 0; }
+
+	private:
+		struct alignas(std::max_align_t) Header
+		{
+			void (*run)(void*)	{ nullptr };	// Invokes, then destroys the callable
+			void (*drop)(void*)	{ nullptr };	// Destroys the callable only
+			uint32_t size{ 0 };					// Whole entry, header included
+			uint32_t previous{ 0 };				// Offset of the previous entry in the block, or NO_ENTRY
+		};
+
+		struct Block
+		{
+			std::unique_ptr<std::byte[]>	data;
+			size_t							capacity{ 0 };
+			size_t							used{ 0 };
+			uint32_t						last{ 0 };	// Offset of the last entry, or NO_ENTRY
+		};
+
+		static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+		[[nodiscard]] static constexpr size_t AlignUp(size_t size)
+		{
+			return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+		}
+
+		[[nodiscard]] std::byte* Allocate(size_t size);
+		void Release(bool run);
+
+	private:
+		size_t				m_BlockSize;
+		std::vector<Block>	m_Blocks;
+		size_t				m_Count{ 0 };
+	};
+
+}
@@ -0,0 +1,168 @@
+#include "FileWatcher.h"
+#include "LogSystem.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace tiny_vulkan {
+
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		constexpr auto POLL_INTERVAL = std::chrono::milliseconds(250);
+
+		std::filesystem::path Canonical(const std::filesystem::path& path)
+		{
+			std::error_code ec;
+			auto canonical = std::filesystem::weakly_canonical(path, ec);
+			return ec ? std::filesystem::absolute(path).lexically_normal() : canonical;
+		}
+	}
+
+	FileWatcher::FileWatcher(Callback callback)
+		: m_Callback(std::move(callback))
+	{
+#ifdef __linux__
+		m_InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_InotifyFd < 0)
+		{
+			LOG_ERROR("inotify_init1 failed, file changes won't be detected");
+			return;
+		}
+#endif
+		m_Thread = std::jthread([this](std::stop_token stopToken) { Run(stopToken); });
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		if (m_Thread.joinable())
+		{
+			m_Thread.request_stop();
+			m_Thread.join();
+		}
+
+#ifdef __linux__
+		if (m_InotifyFd >= 0)
+		{
+			close(m_InotifyFd);
+		}
+#endif
+	}
+
+	void FileWatcher::Watch(const std::filesystem::path& file)
+	{
+		const auto path = Canonical(file);
+
+		std::lock_guard lock(m_Mutex);
+		if (!m_Files.insert(path.generic_string()).second)
+		{
+			return;
+		}
+
+#ifdef __linux__
+		if (m_InotifyFd < 0)
+		{
+			return;
+		}
+
+		const auto directory = path.parent_path();
+		for (const auto& [descriptor, watched] : m_Directories)
+		{
+			if (watched == directory)
+			{
+				return;
+			}
+		}
+
+		// Close-after-write and rename-into cover both in-place saves and atomic replaces
+		const int descriptor = inotify_add_watch(m_InotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (descriptor < 0)
+		{
+			LOG_WARN(fmt::runtime("Cannot watch directory: {}"), directory.string());
+			return;
+		}
+		m_Directories[descriptor] = directory;
+#else
+		std::error_code ec;
+		m_WriteTimes[path.generic_string()] = std::filesystem::last_write_time(path, ec);
+#endif
+	}
+
+	void FileWatcher::Run(std::stop_token stopToken)
+	{
+#ifdef __linux__
+		alignas(inotify_event) char buffer[4096];
+
+		while (!stopToken.stop_requested())
+		{
+			pollfd descriptor{ .fd = m_InotifyFd, .events = POLLIN, .revents = 0 };
+			if (poll(&descriptor, 1, static_cast<int>(POLL_INTERVAL.count())) <= 0)
+			{
+				continue;
+			}
+
+			const ssize_t length = read(m_InotifyFd, buffer, sizeof(buffer));
+			if (length <= 0)
+			{
+				continue;
+			}
+
+			std::vector<std::filesystem::path> modified;
+			{
+				std::lock_guard lock(m_Mutex);
+				for (ssize_t offset = 0; offset < length; )
+				{
+					const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+					offset += sizeof(inotify_event) + event->len;
+
+					auto it = m_Directories.find(event->wd);
+					if (event->len == 0 || it == m_Directories.end())
+					{
+						continue;
+					}
+
+					auto path = it->second / event->name;
+					if (m_Files.contains(path.generic_string()))
+					{
+						modified.push_back(std::move(path));
+					}
+				}
+			}
+
+			// Outside the lock, the callback may watch more files
+			for (const auto& path : modified)
+			{
+				m_Callback(path);
+			}
+		}
+#else
+		while (!stopToken.stop_requested())
+		{
+			std::this_thread::sleep_for(POLL_INTERVAL);
+
+			std::vector<std::filesystem::path> modified;
+			{
+				std::lock_guard lock(m_Mutex);
+				for (auto& [path, writeTime] : m_WriteTimes)
+				{
+					std::error_code ec;
+					const auto current = std::filesystem::last_write_time(path, ec);
+					if (!ec && current != writeTime)
+					{
+						writeTime = current;
+						modified.emplace_back(path);
+					}
+				}
+			}
+
+			for (const auto& path : modified)
+			{
+				m_Callback(path);
+			}
+		}
+#endif
+	}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace tiny_vulkan {
+
+	/**
+	 * @brief Reports modifications of a set of files from a background thread.
+	 * Uses inotify on Linux (directory watches, so editors saving through a rename are seen),
+	 * and polls the last write times elsewhere.
+	 */
+	class FileWatcher
+	{
+	public:
+		// Invoked on the watcher thread with the canonical path of the modified file.
+		using Callback = std::function<void(const std::filesystem::path&)>;
+
+		explicit FileWatcher(Callback callback);
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		// Adding a file twice is a no-op.
+		void Watch(const std::filesystem::path& file);
+
+	private:
+		void Run(std::stop_token stopToken);
+
+	private:
+		Callback									m_Callback;
+		std::mutex									m_Mutex;
+		std::unordered_set<std::string>				m_Files;		// Canonical generic paths
+#ifdef __linux__
+		int											m_InotifyFd{ -1 };
+		std::unordered_map<int, std::filesystem::path> m_Directories;	// Watch descriptor -> directory
+#else
+		std::unordered_map<std::string, std::filesystem::file_time_type> m_WriteTimes;
+#endif
+		std::jthread								m_Thread;		// Last, stopped before the members above are gone
+	};
+
+}
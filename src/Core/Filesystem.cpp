@@ -1,6 +1,16 @@
 #include "Filesystem.h"
 #include "LogSystem.h"
 
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
 namespace tiny_vulkan::IO {
 
 	std::optional<std::string> ReadFile(const std::filesystem::path& path)
@@ -67,4 +77,51 @@ namespace tiny_vulkan::IO {
 		return buffer;
 	}
 
-}
\ No newline at end of file
+	bool WritePPM(const std::filesystem::path& path, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgb)
+	{
+		if (rgb.size() != static_cast<size_t>(width) * height * 3)
+		{
+			LOG_ERROR(fmt::runtime("PPM pixel count doesn't match {0}x{1}: {2}"), width, height, path.string());
+			return false;
+		}
+
+		std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			LOG_ERROR(fmt::runtime("Failed to open file: {}"), path.string());
+			return false;
+		}
+
+		file << "P6\n" << width << ' ' << height << "\n255\n";
+		file.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+
+		return file.good();
+	}
+
+	std::filesystem::path GetExecutableDirectory()
+	{
+		std::error_code ec;
+#if defined(_WIN32)
+		std::wstring buffer(MAX_PATH, L'\0');
+		DWORD length = 0;
+		while ((length = GetModuleFileNameW(nullptr, buffer.data(), static_cast<DWORD>(buffer.size()))) == buffer.size())
+		{
+			buffer.resize(buffer.size() * 2);
+		}
+		if (length > 0)
+		{
+			buffer.resize(length);
+			return std::filesystem::path(buffer).parent_path();
+		}
+#elif defined(__linux__)
+		auto executable = std::filesystem::read_symlink("/proc/self/exe", ec);
+		if (!ec)
+		{
+			return executable.parent_path();
+		}
+#endif
+		LOG_WARN("Executable directory unknown, using the working directory");
+		return std::filesystem::current_path(ec);
+	}
+
+}
@@ -16,4 +16,11 @@ namespace tiny_vulkan::IO {
     [[nodiscard]]
     std::optional<std::vector<uint32_t>> ReadFileBin(const std::filesystem::path& path);
 
+    // Writes 8-bit RGB pixels, rows top to bottom, as a binary PPM (P6). Returns false on failure.
+    bool WritePPM(const std::filesystem::path& path, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgb);
+
+    // Directory of the running executable, the working directory where the platform can't tell.
+    [[nodiscard]]
+    std::filesystem::path GetExecutableDirectory();
+
 }
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+namespace tiny_vulkan::Hash {
+
+	constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+	constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+	// FNV-1a over a raw byte range. Stable across runs and platforms, so it is safe for on-disk keys.
+	[[nodiscard]] inline uint64_t Bytes(const void* data, size_t size, uint64_t seed = FNV_OFFSET_BASIS)
+	{
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		uint64_t hash = seed;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+
+	[[nodiscard]] inline uint64_t String(std::string_view str, uint64_t seed = FNV_OFFSET_BASIS)
+	{
+		return Bytes(str.data(), str.size(), seed);
+	}
+
+	// Mixes an already computed hash into seed (boost::hash_combine, 64-bit constant).
+	inline void CombineHash(uint64_t& seed, uint64_t hash)
+	{
+		seed ^= hash + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+	}
+
+	// Mixes a trivially copyable value (enum, integer, handle, flags) into seed.
+	template<typename T>
+	inline void Combine(uint64_t& seed, const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Hash::Combine expects a trivially copyable value");
+		CombineHash(seed, Bytes(&value, sizeof(T)));
+	}
+
+}
@@ -1,28 +1,28 @@
 #include "LifetimeManager.h"
-#include <vector>
 
 namespace tiny_vulkan::LifetimeManager {
 
 	namespace {
 		// Internal linkage: accessible only within this translation unit.
-		std::vector<std::function<void()>> g_Deleters;
+		DestructorList g_Deleters;
 	}
 
-	void RegisterDeleter(std::function<void()>&& deleter)
+	DestructorList& GetDeleters()
 	{
-		g_Deleters.push_back(std::move(deleter));
+		return g_Deleters;
 	}
 
-	void ExecuteAll()
+	void RegisterDeleter(std::function<void()>&& deleter)
 	{
-		// Iterate in reverse order (LIFO)
-		for (auto it = g_Deleters.rbegin(); it != g_Deleters.rend(); ++it)
+		if (deleter)
 		{
-			if (*it) 
-			{
-				(*it)();
-			}
+			g_Deleters.Push(std::move(deleter));
 		}
-		g_Deleters.clear();
 	}
-}
\ No newline at end of file
+
+	void ExecuteAll()
+	{
+		// Runs in reverse order (LIFO)
+		g_Deleters.ExecuteAll();
+	}
+}
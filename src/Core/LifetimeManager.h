@@ -1,13 +1,18 @@
 #pragma once
 
+#include "DestructorList.h"
+
 #include <functional>
 
 namespace tiny_vulkan::LifetimeManager {
 
+	// Deleters in registration order, stored inline (no allocation per entry).
+	[[nodiscard]] DestructorList& GetDeleters();
+
 	template<typename F, typename... Args>
 	void PushFunction(F&& function, Args&&... args)
 	{
-		RegisterDeleter([func = std::forward<F>(function), ...args = std::forward<Args>(args)]()
+		GetDeleters().Push([func = std::forward<F>(function), ...args = std::forward<Args>(args)]()
 			{
 				std::invoke(func, args...);
 			});
@@ -22,4 +27,4 @@ namespace tiny_vulkan::LifetimeManager {
 	void RegisterDeleter(std::function<void()>&& deleter);
 
 	void ExecuteAll();
-}
\ No newline at end of file
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace tiny_vulkan {
+
+	/**
+	 * @brief Slot index into a ResourcePool plus the generation of that slot when the resource was created.
+	 * A handle outliving its resource is detected (Get returns nullptr) instead of aliasing whatever reuses the slot.
+	 */
+	template<typename T>
+	struct Handle
+	{
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+		uint32_t index{ INVALID_INDEX };
+		uint32_t generation{ 0 };
+
+		[[nodiscard]] bool IsValid() const { return index != INVALID_INDEX; }
+		bool operator==(const Handle&) const = default;
+	};
+
+	/**
+	 * @brief Dense array of T addressed by generation-checked handles, O(1) create/lookup/release.
+	 * Released slots are recycled with a new generation. Not thread-safe.
+	 */
+	template<typename T>
+	class ResourcePool
+	{
+	public:
+		template<typename... Args>
+		[[nodiscard]] Handle<T> Create(Args&&... args)
+		{
+			uint32_t index = 0;
+			if (!m_FreeSlots.empty())
+			{
+				index = m_FreeSlots.back();
+				m_FreeSlots.pop_back();
+			}
+			else
+			{
+				index = (uint32_t)m_Slots.size();
+				m_Slots.emplace_back();
+				m_Generations.push_back(0);
+			}
+
+			m_Slots[index].emplace(std::forward<Args>(args)...);
+			++m_AliveCount;
+			return Handle<T>{ .index = index, .generation = m_Generations[index] };
+		}
+
+		[[nodiscard]] bool IsAlive(Handle<T> handle) const
+		{
+			return handle.index < m_Slots.size() && m_Generations[handle.index] == handle.generation && m_Slots[handle.index].has_value();
+		}
+
+		// nullptr for a stale or invalid handle.
+		[[nodiscard]] T*		Get(Handle<T> handle)		{ return IsAlive(handle) ? &*m_Slots[handle.index] : nullptr; }
+		[[nodiscard]] const T*	Get(Handle<T> handle) const	{ return IsAlive(handle) ? &*m_Slots[handle.index] : nullptr; }
+
+		// Destroys the resource now (T's destructor decides when the GPU side goes). False for a stale handle.
+		bool Release(Handle<T> handle)
+		{
+			if (!IsAlive(handle))
+			{
+				return false;
+			}
+
+			m_Slots[handle.index].reset();
+			++m_Generations[handle.index];
+			m_FreeSlots.push_back(handle.index);
+			--m_AliveCount;
+			return true;
+		}
+
+		// Releases everything, handles given out so far all become stale.
+		void Clear()
+		{
+			for (uint32_t index = 0; index < m_Slots.size(); ++index)
+			{
+				if (m_Slots[index].has_value())
+				{
+					Release(Handle<T>{ .index = index, .generation = m_Generations[index] });
+				}
+			}
+		}
+
+		[[nodiscard]] size_t GetAliveCount()	const { return m_AliveCount; }
+		[[nodiscard]] size_t GetCapacity()		const { return m_Slots.size(); }
+
+	private:
+		std::vector<std::optional<T>>	m_Slots;
+		std::vector<uint32_t>			m_Generations;
+		std::vector<uint32_t>			m_FreeSlots;
+		size_t							m_AliveCount{ 0 };
+	};
+
+}
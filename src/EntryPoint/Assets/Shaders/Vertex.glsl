@@ -0,0 +1,9 @@
+// Mirrors tiny_vulkan::Vertex in Mesh.h, keep both in sync.
+struct Vertex
+{
+	vec3 position;
+	float uv_x;
+	vec3 normal;
+	float uv_y;
+	vec4 color;
+};
@@ -3,29 +3,27 @@
 
 layout(location = 0) out vec4 vertexColor;
 
-struct Vertex
-{
-	vec3 position;
-	float uv_x;
-	vec3 normal;
-	float uv_y;
-	vec4 color;
-};
+#include "Vertex.glsl"
 
 layout(buffer_reference, std430) readonly buffer VertexBuffer
 {
 	Vertex vertices[];
 };
 
+// Written by vertexTransform.comp for this frame
+layout(buffer_reference, std430) readonly buffer PositionBuffer
+{
+	vec4 positions[];
+};
+
 layout( push_constant ) uniform PushConstants
 {
-	mat4 worldMatrix;
 	VertexBuffer vertexBuffer;
+	PositionBuffer positionBuffer;
 } push_constants;
 
 void main()
 {
-	Vertex v = push_constants.vertexBuffer.vertices[gl_VertexIndex];
-	gl_Position = push_constants.worldMatrix * vec4(v.position, 1.0f);
-	vertexColor = v.color;
+	gl_Position = push_constants.positionBuffer.positions[gl_VertexIndex];
+	vertexColor = push_constants.vertexBuffer.vertices[gl_VertexIndex].color;
 }
\ No newline at end of file
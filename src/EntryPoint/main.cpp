@@ -1,14 +1,107 @@
 #include "Application.h"
 
-int main()
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+namespace {
+
+    constexpr const char* USAGE =
+        "Usage: TinyVulkan [options]\n"
+        "  --headless          Render offscreen without a window, needs --frames\n"
+        "  --frames <count>    Frames to render before exiting (required headless)\n"
+        "  --readback <path>   Write the last headless frame to a PPM file\n"
+        "  --direct            Render straight into the swapchain image, no render target nor blit\n"
+        "  --frame-stats       Log averaged CPU/GPU frame times and barrier counts\n"
+        "  --bench-pipelines   Compare pipeline and shader object creation/bind costs, then exit\n";
+
+    bool ParseCount(const char* text, uint32_t& value)
+    {
+        const char* end = text + std::strlen(text);
+        auto [ptr, ec] = std::from_chars(text, end, value);
+        return ec == std::errc() && ptr == end;
+    }
+
+    // Overrides the defaults of appSpec with the command line, false (usage printed) on invalid arguments
+    bool ParseArguments(int argc, char** argv, tiny_vulkan::ApplicationSpec& appSpec)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg = argv[i];
+            const char* next = i + 1 < argc ? argv[i + 1] : nullptr;
+
+            if (arg == "--headless")
+            {
+                appSpec.headless = true;
+            }
+            else if (arg == "--frames" && next && ParseCount(next, appSpec.frameCount))
+            {
+                ++i;
+            }
+            else if (arg == "--readback" && next)
+            {
+                appSpec.readbackPath = next;
+                ++i;
+            }
+            else if (arg == "--direct")
+            {
+                appSpec.renderSettings.directToSwapchain = true;
+            }
+            else if (arg == "--frame-stats")
+            {
+                appSpec.renderSettings.logFrameStats = true;
+            }
+            else if (arg == "--bench-pipelines")
+            {
+                appSpec.benchmarkPipelines = true;
+            }
+            else
+            {
+                std::cerr << "Invalid argument: " << arg << '\n' << USAGE;
+                return false;
+            }
+        }
+
+        if (appSpec.headless && appSpec.frameCount == 0 && !appSpec.benchmarkPipelines)
+        {
+            std::cerr << "--headless needs --frames <count> greater than 0\n" << USAGE;
+            return false;
+        }
+        if (!appSpec.headless && appSpec.readbackPath)
+        {
+            std::cerr << "--readback only applies to --headless runs\n" << USAGE;
+            return false;
+        }
+        return true;
+    }
+
+}
+
+int main(int argc, char** argv)
 {
     tiny_vulkan::ApplicationSpec appSpec;
     appSpec.windowWidth = 1280;
     appSpec.windowHeight = 720;
     appSpec.windowName = "TinyVulkan";
+    appSpec.renderSettings.framesInFlight = 3;
+    appSpec.renderSettings.presentMode = tiny_vulkan::PresentMode::FIFO;
+    appSpec.renderSettings.lowLatency = false;
+    appSpec.renderSettings.dynamicResolution = false;
+    appSpec.renderSettings.gpuBudgetMs = 16.0f;
+    appSpec.renderSettings.directToSwapchain = false;
+    appSpec.renderSettings.logFrameStats = false;
+    appSpec.headless = false;
+    appSpec.frameCount = 0;
+    appSpec.readbackPath = nullptr;
+
+    if (!ParseArguments(argc, argv, appSpec))
+    {
+        return 1;
+    }
 
     tiny_vulkan::Application application(appSpec);
     application.Run();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,12 +1,19 @@
 #include "Mesh.h"
 #include "VulkanCore.h"
 #include "CommandsExecutor.h"
-#include "LifetimeManager.h"
+#include "GpuResources.h"
+#include "DeletionQueue.h"
 
 #include <vk_mem_alloc.h>
 
 namespace tiny_vulkan {
 
+	Mesh::~Mesh()
+	{
+		GpuResources::ReleaseBuffer(vertexBuffer);
+		GpuResources::ReleaseBuffer(indexBuffer);
+	}
+
 	std::shared_ptr<Mesh> Mesh::CreateMeshFrom(
 		const std::string& name,
 		const std::span<Vertex>& vertices,
@@ -23,30 +30,33 @@ namespace tiny_vulkan {
 		auto mesh = std::make_shared<Mesh>();
 		mesh->name = name;
 		mesh->subMeshesGeo = subMeshesGeo;
+		mesh->vertexCount = static_cast<uint32_t>(vertices.size());
 
 		// Allocate index and vertex buffers in GPU VRAM
-		// Vertex buffer
+		// Vertex buffer, also read by the compute queue (vertex transform)
 		mesh->vertexBuffer = VulkanBufferBuilder()
 			.SetAllocationPlace(VMA_MEMORY_USAGE_GPU_ONLY)
 			.SetAllocationSize(vertexBufferSize)
 			.SetUsageMask(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT_EXT)
-			.Build();
-
-		VkBufferDeviceAddressInfo addressInfo = {};
-		addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
-		addressInfo.pNext = nullptr;
-		addressInfo.buffer = mesh->vertexBuffer->GetRaw();
-		mesh->vertexBufferAddress = vkGetBufferDeviceAddress(device, &addressInfo);
-
-		LifetimeManager::PushFunction(vmaDestroyBuffer, allocator, mesh->vertexBuffer->GetRaw(), mesh->vertexBuffer->GetAllocation());
+			.SetQueueFamilies({ VulkanCore::GetGraphicsFamily(), VulkanCore::GetComputeFamily() })
+			.BuildHandle();
 
 		// Index buffer
 		mesh->indexBuffer = VulkanBufferBuilder()
 			.SetAllocationPlace(VMA_MEMORY_USAGE_GPU_ONLY)
 			.SetAllocationSize(indexBufferSize)
 			.SetUsageMask(VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
-			.Build();
-		LifetimeManager::PushFunction(vmaDestroyBuffer, allocator, mesh->indexBuffer->GetRaw(), mesh->indexBuffer->GetAllocation());
+			.BuildHandle();
+
+		// Raw handles, pool pointers are not stable across creations
+		VkBuffer vertexBuffer = GpuResources::GetBuffer(mesh->vertexBuffer)->GetRaw();
+		VkBuffer indexBuffer = GpuResources::GetBuffer(mesh->indexBuffer)->GetRaw();
+
+		VkBufferDeviceAddressInfo addressInfo = {};
+		addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+		addressInfo.pNext = nullptr;
+		addressInfo.buffer = vertexBuffer;
+		mesh->vertexBufferAddress = vkGetBufferDeviceAddress(device, &addressInfo);
 
 		// Setup staging buffer
 		auto stagingBuffer = VulkanBufferBuilder()
@@ -64,7 +74,7 @@ namespace tiny_vulkan {
 
 		vmaUnmapMemory(allocator, stagingBuffer->GetAllocation());
 
-		CommandExecutor::Execute(
+		const uint64_t uploadFrame = CommandExecutor::Submit(
 			[&](VkCommandBuffer cmdBuffer)
 			{
 				// Copy vertex part from staging to vertex buffer in VRAM
@@ -72,19 +82,24 @@ namespace tiny_vulkan {
 				vertexBufferCopy.dstOffset = 0;
 				vertexBufferCopy.srcOffset = 0;
 				vertexBufferCopy.size = vertexBufferSize;
-				vkCmdCopyBuffer(cmdBuffer, stagingBuffer->GetRaw(), mesh->vertexBuffer->GetRaw(), 1, &vertexBufferCopy);
+				vkCmdCopyBuffer(cmdBuffer, stagingBuffer->GetRaw(), vertexBuffer, 1, &vertexBufferCopy);
 
 				// Copy index part from staging to index buffer in VRAM
 				VkBufferCopy indexBufferCopy = {};
 				indexBufferCopy.dstOffset = 0;
 				indexBufferCopy.srcOffset = vertexBufferSize;
 				indexBufferCopy.size = indexBufferSize;
-				vkCmdCopyBuffer(cmdBuffer, stagingBuffer->GetRaw(), mesh->indexBuffer->GetRaw(), 1, &indexBufferCopy);
-
-				LifetimeManager::ExecuteNow(vmaDestroyBuffer, allocator, stagingBuffer->GetRaw(), stagingBuffer->GetAllocation());
+				vkCmdCopyBuffer(cmdBuffer, stagingBuffer->GetRaw(), indexBuffer, 1, &indexBufferCopy);
 			}
 		);
 
+		// The upload isn't waited for: the staging buffer is kept until the timeline reaches uploadFrame.
+		// The mesh buffers are released when the mesh is dropped, after the frames that may still read them completed.
+		DeletionQueue::PushFunctionAt(uploadFrame, [staging = std::move(stagingBuffer)]() mutable
+			{
+				staging.reset();
+			});
+
 		return mesh;
 	}
 
@@ -10,6 +10,7 @@
 
 namespace tiny_vulkan {
 
+	// GPU layout shared with the shaders through Assets/Shaders/Vertex.glsl
 	struct Vertex
 	{
 		glm::vec3 position;
@@ -27,14 +28,21 @@ namespace tiny_vulkan {
 
 	struct Mesh
 	{
+		Mesh() = default;
+		~Mesh(); // Releases the pooled buffers
+
+		Mesh(const Mesh&) = delete;
+		Mesh& operator=(const Mesh&) = delete;
+
 		std::string name;
 
 		std::vector<SubMeshGeo> subMeshesGeo;
 
-		std::shared_ptr<VulkanBuffer> vertexBuffer;
-		std::shared_ptr<VulkanBuffer> indexBuffer;
+		BufferHandle vertexBuffer;
+		BufferHandle indexBuffer;
 
 		VkDeviceAddress vertexBufferAddress;
+		uint32_t vertexCount{ 0 };
 
 		static std::shared_ptr<Mesh> CreateMeshFrom(
 			const std::string& name, 
@@ -0,0 +1,160 @@
+#include "AsyncCompute.h"
+#include "VulkanCore.h"
+#include "LifetimeManager.h"
+#include "LogSystem.h"
+
+namespace tiny_vulkan {
+
+	// Definition of static members
+	VkDevice									AsyncCompute::s_Device = VK_NULL_HANDLE;
+	VkQueue										AsyncCompute::s_Queue = VK_NULL_HANDLE;
+	VkCommandPool								AsyncCompute::s_CommandPool = VK_NULL_HANDLE;
+	std::vector<AsyncCompute::SubmittedBuffer>	AsyncCompute::s_CommandBuffers;
+	VkSemaphore									AsyncCompute::s_Timeline = VK_NULL_HANDLE;
+	uint64_t									AsyncCompute::s_SubmittedValue = 0;
+	VkPipelineStageFlags2						AsyncCompute::s_PendingWaitStage = VK_PIPELINE_STAGE_2_NONE;
+	bool										AsyncCompute::s_Initialized = false;
+
+	void AsyncCompute::Initialize()
+	{
+		if (s_Initialized)
+		{
+			return;
+		}
+		s_Initialized = true;
+
+		s_Device = VulkanCore::GetDevice();
+		s_Queue = VulkanCore::GetComputeQueue();
+
+		// Pool
+		VkCommandPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		poolInfo.queueFamilyIndex = VulkanCore::GetComputeFamily();
+		CHECK_VK_RES(vkCreateCommandPool(s_Device, &poolInfo, nullptr, &s_CommandPool));
+
+		// Timeline: value N once the N-th submission completed
+		VkSemaphoreTypeCreateInfo typeInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		semaphoreInfo.pNext = &typeInfo;
+		CHECK_VK_RES(vkCreateSemaphore(s_Device, &semaphoreInfo, nullptr, &s_Timeline));
+
+		// Cleanup (the pool frees its command buffers)
+		LifetimeManager::PushFunction(vkDestroySemaphore, s_Device, s_Timeline, nullptr);
+		LifetimeManager::PushFunction(vkDestroyCommandPool, s_Device, s_CommandPool, nullptr);
+	}
+
+	uint64_t AsyncCompute::GetCompletedValue()
+	{
+		uint64_t value = 0;
+		CHECK_VK_RES(vkGetSemaphoreCounterValue(s_Device, s_Timeline, &value));
+		return value;
+	}
+
+	VkCommandBuffer AsyncCompute::AcquireCommandBuffer()
+	{
+		const uint64_t completedValue = GetCompletedValue();
+		for (auto& submitted : s_CommandBuffers)
+		{
+			if (submitted.value <= completedValue)
+			{
+				submitted.value = s_SubmittedValue + 1;
+				CHECK_VK_RES(vkResetCommandBuffer(submitted.cmdBuffer, 0));
+				return submitted.cmdBuffer;
+			}
+		}
+
+		// Allocate
+		VkCommandBufferAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = s_CommandPool;
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer cmdBuffer{ VK_NULL_HANDLE };
+		CHECK_VK_RES(vkAllocateCommandBuffers(s_Device, &allocInfo, &cmdBuffer));
+		s_CommandBuffers.push_back(SubmittedBuffer{ .cmdBuffer = cmdBuffer, .value = s_SubmittedValue + 1 });
+		return cmdBuffer;
+	}
+
+	uint64_t AsyncCompute::Submit(
+		std::function<void(VkCommandBuffer cmd)>&&	func,
+		VkPipelineStageFlags2						graphicsWaitStage,
+		uint64_t									waitFrame)
+	{
+		if (!s_Initialized)
+		{
+			LOG_ERROR("Async compute is not initialized!");
+			abort();
+		}
+
+		// The next frame submit joins this work: it can't also be what this work waits for
+		if (waitFrame >= VulkanCore::GetFrameNumber())
+		{
+			LOG_ERROR(fmt::runtime("Async compute can't wait for frame {0}, only for frames already submitted (before {1})"),
+				waitFrame,
+				VulkanCore::GetFrameNumber()
+			);
+			abort();
+		}
+
+		VkCommandBuffer cmdBuffer = AcquireCommandBuffer();
+
+		// Recording
+		VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		CHECK_VK_RES(vkBeginCommandBuffer(cmdBuffer, &beginInfo));
+
+		if (func)
+		{
+			func(cmdBuffer);
+		}
+
+		CHECK_VK_RES(vkEndCommandBuffer(cmdBuffer));
+
+		// Submit: the frame may not be submitted yet, timelines allow waiting before the signal
+		VkSemaphoreSubmitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
+		waitInfo.semaphore = VulkanCore::GetFrameTimeline();
+		waitInfo.value = waitFrame;
+		waitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+		VkSemaphoreSubmitInfo signalInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
+		signalInfo.semaphore = s_Timeline;
+		signalInfo.value = ++s_SubmittedValue;
+		signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+		VkCommandBufferSubmitInfo cmdInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
+		cmdInfo.commandBuffer = cmdBuffer;
+
+		VkSubmitInfo2 submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
+		submitInfo.waitSemaphoreInfoCount = waitFrame > 0 ? 1 : 0;
+		submitInfo.pWaitSemaphoreInfos = &waitInfo;
+		submitInfo.signalSemaphoreInfoCount = 1;
+		submitInfo.pSignalSemaphoreInfos = &signalInfo;
+		submitInfo.commandBufferInfoCount = 1;
+		submitInfo.pCommandBufferInfos = &cmdInfo;
+		CHECK_VK_RES(vkQueueSubmit2(s_Queue, 1, &submitInfo, VK_NULL_HANDLE));
+
+		// Joined into the next frame, so the frame timeline still covers every earlier submission
+		s_PendingWaitStage |= graphicsWaitStage;
+		return s_SubmittedValue;
+	}
+
+	bool AsyncCompute::ConsumeGraphicsWait(VkSemaphoreSubmitInfo& waitInfo)
+	{
+		if (s_PendingWaitStage == VK_PIPELINE_STAGE_2_NONE)
+		{
+			return false;
+		}
+
+		waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
+		waitInfo.semaphore = s_Timeline;
+		waitInfo.value = s_SubmittedValue;
+		waitInfo.stageMask = s_PendingWaitStage;
+
+		s_PendingWaitStage = VK_PIPELINE_STAGE_2_NONE;
+		return true;
+	}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+namespace tiny_vulkan {
+
+	/**
+	 * @brief Compute submissions on the compute queue (VulkanCore::GetComputeQueue), ordered with the
+	 * graphics frames by timeline semaphores: the compute timeline counts submissions, the frame timeline frames.
+	 * Exclusive resources crossing queues need an ownership transfer (BarrierBatch Release/Acquire halves)
+	 * with the families of both queues, they reduce to plain barriers when compute shares the graphics queue.
+	 */
+	class AsyncCompute
+	{
+	public:
+		AsyncCompute() = delete;
+
+		static void Initialize();
+
+		/**
+		 * @brief Records func and submits it without waiting.
+		 * The next graphics frame waits for it at graphicsWaitStage, the first stage consuming its results:
+		 * graphics work before that stage overlaps the compute. A non-zero waitFrame makes the compute wait
+		 * for that frame's graphics work first (frame timeline), e.g. to acquire what the frame released.
+		 * It has to be an already submitted frame (below VulkanCore::GetFrameNumber()): the frame being
+		 * recorded waits for this submission, waiting for it in turn would deadlock both queues.
+		 * Returns the compute timeline value signaled once the work completed.
+		 */
+		static uint64_t Submit(
+			std::function<void(VkCommandBuffer cmd)>&&	func,
+			VkPipelineStageFlags2						graphicsWaitStage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			uint64_t									waitFrame = 0
+		);
+
+		// Wait the graphics submission has to add, false if nothing was submitted since the last one.
+		[[nodiscard]] static bool ConsumeGraphicsWait(VkSemaphoreSubmitInfo& waitInfo);
+
+		[[nodiscard]] static VkSemaphore	GetTimeline()		{ return s_Timeline; }
+		[[nodiscard]] static uint64_t		GetSubmittedValue()	{ return s_SubmittedValue; }
+		[[nodiscard]] static uint64_t		GetCompletedValue();
+
+	private:
+		struct SubmittedBuffer
+		{
+			VkCommandBuffer	cmdBuffer{ VK_NULL_HANDLE };
+			uint64_t		value{ 0 };		// Reusable once the compute timeline reaches it
+		};
+
+		static VkCommandBuffer AcquireCommandBuffer();
+
+	private:
+		static VkDevice						s_Device;
+		static VkQueue						s_Queue;
+		static VkCommandPool				s_CommandPool;
+		static std::vector<SubmittedBuffer>	s_CommandBuffers;
+		static VkSemaphore					s_Timeline;
+		static uint64_t						s_SubmittedValue;
+		static VkPipelineStageFlags2		s_PendingWaitStage;		// Graphics stages waiting on s_SubmittedValue
+		static bool							s_Initialized;
+	};
+
+}
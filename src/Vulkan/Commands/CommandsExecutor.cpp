@@ -6,12 +6,11 @@
 namespace tiny_vulkan {
 
 	// Definition of static members
-	VkDevice        CommandExecutor::s_Device = VK_NULL_HANDLE;
-	VkQueue			CommandExecutor::s_GraphicsQueue;
-	VkCommandPool   CommandExecutor::s_CommandPool = VK_NULL_HANDLE;
-	VkCommandBuffer CommandExecutor::s_CommandBuffer = VK_NULL_HANDLE;
-	VkFence			CommandExecutor::s_Fence;
-	bool            CommandExecutor::s_Initialized = false;
+	VkDevice									CommandExecutor::s_Device = VK_NULL_HANDLE;
+	VkQueue										CommandExecutor::s_GraphicsQueue;
+	VkCommandPool								CommandExecutor::s_CommandPool = VK_NULL_HANDLE;
+	std::vector<CommandExecutor::SubmittedBuffer> CommandExecutor::s_CommandBuffers;
+	bool										CommandExecutor::s_Initialized = false;
 
 	void CommandExecutor::Initialize() 
 	{
@@ -34,25 +33,38 @@ namespace tiny_vulkan {
 		poolInfo.queueFamilyIndex = VulkanCore::GetGraphicsFamily();
 		CHECK_VK_RES(vkCreateCommandPool(s_Device, &poolInfo, nullptr, &s_CommandPool));
 
+		// Cleanup (the pool frees its command buffers)
+		LifetimeManager::PushFunction(vkDestroyCommandPool, s_Device, s_CommandPool, nullptr);
+	}
+
+	VkCommandBuffer CommandExecutor::AcquireCommandBuffer()
+	{
+		// Uploads in flight complete with the frame recorded when they were submitted
+		const uint64_t completedFrame = VulkanCore::GetCompletedFrame();
+		for (auto& submitted : s_CommandBuffers)
+		{
+			if (submitted.frame <= completedFrame)
+			{
+				submitted.frame = VulkanCore::GetFrameNumber();
+				CHECK_VK_RES(vkResetCommandBuffer(submitted.cmdBuffer, 0));
+				return submitted.cmdBuffer;
+			}
+		}
+
 		// Allocate
 		VkCommandBufferAllocateInfo allocInfo = {};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 		allocInfo.commandPool = s_CommandPool;
 		allocInfo.commandBufferCount = 1;
-		CHECK_VK_RES(vkAllocateCommandBuffers(s_Device, &allocInfo, &s_CommandBuffer));
-
-		// Fence 
-		VkFenceCreateInfo fenceInfo = {};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		CHECK_VK_RES(vkCreateFence(s_Device, &fenceInfo, nullptr, &s_Fence));
 
-		// Cleanup
-		LifetimeManager::PushFunction(vkDestroyFence, s_Device, s_Fence, nullptr);
-		LifetimeManager::PushFunction(vkDestroyCommandPool, s_Device, s_CommandPool, nullptr);
+		VkCommandBuffer cmdBuffer{ VK_NULL_HANDLE };
+		CHECK_VK_RES(vkAllocateCommandBuffers(s_Device, &allocInfo, &cmdBuffer));
+		s_CommandBuffers.push_back(SubmittedBuffer{ .cmdBuffer = cmdBuffer, .frame = VulkanCore::GetFrameNumber() });
+		return cmdBuffer;
 	}
 
-	void CommandExecutor::Execute(std::function<void(VkCommandBuffer cmd)>&& func)
+	uint64_t CommandExecutor::Submit(std::function<void(VkCommandBuffer cmd)>&& func)
 	{
 		if (!s_Initialized) 
 		{
@@ -60,31 +72,56 @@ namespace tiny_vulkan {
 			abort();
 		}
 
+		VkCommandBuffer cmdBuffer = AcquireCommandBuffer();
+
 		// Recording
 		VkCommandBufferBeginInfo beginInfo = {};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-		CHECK_VK_RES(vkBeginCommandBuffer(s_CommandBuffer, &beginInfo));
+		CHECK_VK_RES(vkBeginCommandBuffer(cmdBuffer, &beginInfo));
 
 		if (func) 
 		{
-			func(s_CommandBuffer);
+			func(cmdBuffer);
 		}
 
-		CHECK_VK_RES(vkEndCommandBuffer(s_CommandBuffer));
+		// Nothing waits on the CPU anymore: later submissions see the writes through this barrier
+		VkMemoryBarrier2 memoryBarrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+		memoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		memoryBarrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+		memoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+		VkDependencyInfo depInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+		depInfo.memoryBarrierCount = 1;
+		depInfo.pMemoryBarriers = &memoryBarrier;
+		vkCmdPipelineBarrier2(cmdBuffer, &depInfo);
+
+		CHECK_VK_RES(vkEndCommandBuffer(cmdBuffer));
 
 		// Submit
 		VkCommandBufferSubmitInfo cmdInfo = {};
 		cmdInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
-		cmdInfo.commandBuffer = s_CommandBuffer;
+		cmdInfo.commandBuffer = cmdBuffer;
 
 		VkSubmitInfo2 submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
 		submitInfo.commandBufferInfoCount = 1;
 		submitInfo.pCommandBufferInfos = &cmdInfo;
-		CHECK_VK_RES(vkQueueSubmit2(s_GraphicsQueue, 1, &submitInfo, s_Fence));
+		CHECK_VK_RES(vkQueueSubmit2(s_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+		return VulkanCore::GetFrameNumber();
+	}
+
+	void CommandExecutor::Execute(std::function<void(VkCommandBuffer cmd)>&& func)
+	{
+		Submit(std::move(func));
 
 		// Wait
-		CHECK_VK_RES(vkWaitForFences(s_Device, 1, &s_Fence, VK_TRUE, UINT64_MAX));
+		CHECK_VK_RES(vkQueueWaitIdle(s_GraphicsQueue));
+		for (auto& submitted : s_CommandBuffers)
+		{
+			submitted.frame = 0;
+		}
 	}
-}
\ No newline at end of file
+}
@@ -3,6 +3,8 @@
 #include <vulkan/vulkan.h>
 #include <functional>
 #include <memory>
+#include <vector>
+#include <cstdint>
 
 namespace tiny_vulkan {
 
@@ -12,15 +14,33 @@ namespace tiny_vulkan {
 		CommandExecutor() = delete;
 
 		static void Initialize();
+
+		/**
+		 * @brief Records func and submits it on the graphics queue without waiting.
+		 * Returns the frame timeline value after which the work is complete: the frame being recorded
+		 * signals after every earlier submission, so resources retired to DeletionQueue meanwhile outlive it.
+		 * The writes are made visible to every later command on the queue.
+		 */
+		static uint64_t Submit(std::function<void(VkCommandBuffer cmd)>&& func);
+
+		// Submit, then block until the queue is idle (e.g. readback).
 		static void Execute(std::function<void(VkCommandBuffer cmd)>&& func);
 
 	private:
-		static VkDevice			s_Device;
-		static VkQueue			s_GraphicsQueue;
-		static VkCommandPool	s_CommandPool;
-		static VkCommandBuffer	s_CommandBuffer;
-		static VkFence			s_Fence;
-		static bool				s_Initialized;
+		struct SubmittedBuffer
+		{
+			VkCommandBuffer	cmdBuffer{ VK_NULL_HANDLE };
+			uint64_t		frame{ 0 };		// Reusable once the frame timeline reaches it
+		};
+
+		static VkCommandBuffer AcquireCommandBuffer();
+
+	private:
+		static VkDevice						s_Device;
+		static VkQueue						s_GraphicsQueue;
+		static VkCommandPool				s_CommandPool;
+		static std::vector<SubmittedBuffer>	s_CommandBuffers;
+		static bool							s_Initialized;
 	};
 
-}
\ No newline at end of file
+}
@@ -1,36 +1,39 @@
 #include "ImageOperations.h"
 #include "VulkanSynchronization.h"
+#include "VulkanBuffer.h"
+#include "CommandsExecutor.h"
+#include "VulkanCore.h"
+#include "LogSystem.h"
 
 namespace tiny_vulkan::ImageOperations {
 
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		// Bytes per texel, 0 for formats readback doesn't handle
+		uint32_t GetTexelSize(VkFormat format)
+		{
+			switch (format)
+			{
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_R8G8B8A8_SRGB:
+			case VK_FORMAT_B8G8R8A8_UNORM:
+			case VK_FORMAT_B8G8R8A8_SRGB:
+				return 4;
+			case VK_FORMAT_R16G16B16A16_SFLOAT:
+				return 8;
+			default:
+				return 0;
+			}
+		}
+	}
+
 	void CmdBlit(
-		VkCommandBuffer				 cmdBuffer,
-		std::shared_ptr<VulkanImage> srcImage,
-		std::shared_ptr<VulkanImage> dstImage,
-		VkExtent3D					 srcExtent,
-		VkExtent3D					 dstExtent)
+		VkCommandBuffer		cmdBuffer,
+		const VulkanImage&	srcImage,
+		const VulkanImage&	dstImage,
+		VkExtent3D			srcExtent,
+		VkExtent3D			dstExtent)
 	{
-		// ========================================================
-		// Transition layouts for Transfer
-		// ========================================================
-		// Prepare Source
-		Synchronization::CmdImageMemoryBarrier(
-			cmdBuffer,
-			srcImage,
-			VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-			VK_ACCESS_2_TRANSFER_READ_BIT,
-			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
-		);
-
-		// Prepare Destination
-		Synchronization::CmdImageMemoryBarrier(
-			cmdBuffer,
-			dstImage,
-			VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-			VK_ACCESS_2_TRANSFER_WRITE_BIT,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-		);
-
 		// ========================================================
 		// Record Blit Command
 		// ========================================================
@@ -49,9 +52,9 @@ namespace tiny_vulkan::ImageOperations {
 
 		VkBlitImageInfo2 blitInfo = {};
 		blitInfo.sType = VK_STRUCTURE_TYPE_BLIT_IMAGE_INFO_2;
-		blitInfo.srcImage = srcImage->GetRaw();
+		blitInfo.srcImage = srcImage.GetRaw();
 		blitInfo.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-		blitInfo.dstImage = dstImage->GetRaw();
+		blitInfo.dstImage = dstImage.GetRaw();
 		blitInfo.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 		blitInfo.filter = VK_FILTER_LINEAR;
 		blitInfo.regionCount = 1;
@@ -60,4 +63,101 @@ namespace tiny_vulkan::ImageOperations {
 		vkCmdBlitImage2(cmdBuffer, &blitInfo);
 	}
 
+	void CmdGenerateMips(VkCommandBuffer cmdBuffer, VulkanImage& image)
+	{
+		const VkExtent3D extent = image.GetExtent();
+		const uint32_t layerCount = image.GetArrayLayers();
+
+		Synchronization::BarrierBatch barriers;
+		for (uint32_t mip = 1; mip < image.GetMipLevels(); ++mip)
+		{
+			// Previous mip becomes the source once written, the next one is the destination
+			barriers
+				.ImageBarrier(image, VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					Synchronization::MakeRange(VK_IMAGE_ASPECT_COLOR_BIT, mip - 1, 1, 0, layerCount))
+				.ImageBarrier(image, VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					Synchronization::MakeRange(VK_IMAGE_ASPECT_COLOR_BIT, mip, 1, 0, layerCount));
+			barriers.Flush(cmdBuffer);
+
+			VkImageBlit2 blitRegion = { VK_STRUCTURE_TYPE_IMAGE_BLIT_2 };
+			blitRegion.srcOffsets[1] = {
+				static_cast<int32_t>(std::max(extent.width >> (mip - 1), 1u)),
+				static_cast<int32_t>(std::max(extent.height >> (mip - 1), 1u)),
+				1 };
+			blitRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blitRegion.srcSubresource.mipLevel = mip - 1;
+			blitRegion.srcSubresource.layerCount = layerCount;
+
+			blitRegion.dstOffsets[1] = {
+				static_cast<int32_t>(std::max(extent.width >> mip, 1u)),
+				static_cast<int32_t>(std::max(extent.height >> mip, 1u)),
+				1 };
+			blitRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blitRegion.dstSubresource.mipLevel = mip;
+			blitRegion.dstSubresource.layerCount = layerCount;
+
+			VkBlitImageInfo2 blitInfo = { VK_STRUCTURE_TYPE_BLIT_IMAGE_INFO_2 };
+			blitInfo.srcImage = image.GetRaw();
+			blitInfo.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			blitInfo.dstImage = image.GetRaw();
+			blitInfo.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			blitInfo.filter = VK_FILTER_LINEAR;
+			blitInfo.regionCount = 1;
+			blitInfo.pRegions = &blitRegion;
+
+			vkCmdBlitImage2(cmdBuffer, &blitInfo);
+		}
+	}
+
+	std::vector<uint8_t> Readback(VulkanImage& image, VkExtent2D region)
+	{
+		const uint32_t texelSize = GetTexelSize(image.GetFormat());
+		if (texelSize == 0)
+		{
+			LOG_ERROR(fmt::runtime("Readback: unsupported format {0}"), string_VkFormat(image.GetFormat()));
+			return {};
+		}
+
+		const VkDeviceSize size = static_cast<VkDeviceSize>(region.width) * region.height * texelSize;
+		auto staging = VulkanBufferBuilder()
+			.SetAllocationSize(size)
+			.SetUsageMask(VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+			.SetAllocationPlace(VMA_MEMORY_USAGE_GPU_TO_CPU)
+			.Build();
+
+		CommandExecutor::Execute([&](VkCommandBuffer cmdBuffer)
+			{
+				// The staging buffer is new: its barrier records nothing, only tracks the copy's write
+				Synchronization::BarrierBatch barriers;
+				barriers
+					.ImageBarrier(image, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						Synchronization::MakeRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1))
+					.BufferBarrier(*staging, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+				barriers.Flush(cmdBuffer);
+
+				VkBufferImageCopy2 copyRegion = { VK_STRUCTURE_TYPE_BUFFER_IMAGE_COPY_2 };
+				copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				copyRegion.imageSubresource.layerCount = 1;
+				copyRegion.imageExtent = VkExtent3D{ region.width, region.height, 1 };
+
+				VkCopyImageToBufferInfo2 copyInfo = { VK_STRUCTURE_TYPE_COPY_IMAGE_TO_BUFFER_INFO_2 };
+				copyInfo.srcImage = image.GetRaw();
+				copyInfo.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				copyInfo.dstBuffer = staging->GetRaw();
+				copyInfo.regionCount = 1;
+				copyInfo.pRegions = &copyRegion;
+				vkCmdCopyImageToBuffer2(cmdBuffer, &copyInfo);
+
+				// The host reads the copy once the queue is idle
+				barriers.BufferBarrier(*staging, VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT);
+				barriers.Flush(cmdBuffer);
+			});
+
+		// Host visible memory may not be coherent
+		CHECK_VK_RES(vmaInvalidateAllocation(VulkanCore::GetVmaAllocator(), staging->GetAllocation(), 0, VK_WHOLE_SIZE));
+
+		const auto* mapped = static_cast<const uint8_t*>(staging->GetAllocationInfo().pMappedData);
+		return std::vector<uint8_t>(mapped, mapped + size);
+	}
+
 }
\ No newline at end of file
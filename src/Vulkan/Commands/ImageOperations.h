@@ -3,20 +3,37 @@
 #include "VulkanImage.h"
 
 #include <memory>
+#include <vector>
+#include <cstdint>
 #include <vulkan/vulkan.h>
 
 namespace tiny_vulkan::ImageOperations {
 
 	/**
 	 * @brief Blits (copies with scaling/format conversion) from source to destination.
-	 * Automatically handles Layout Transitions.
+	 * Expects srcImage in TRANSFER_SRC_OPTIMAL and dstImage in TRANSFER_DST_OPTIMAL (the render graph transitions them).
+	 * The extents are regions from the origin, so a srcExtent smaller than the image upscales a part of it.
 	 */
 	void CmdBlit(
-		VkCommandBuffer				 cmdBuffer,
-		std::shared_ptr<VulkanImage> srcImage,
-		std::shared_ptr<VulkanImage> dstImage,
-		VkExtent3D					 srcExtent,
-		VkExtent3D					 dstExtent
+		VkCommandBuffer		cmdBuffer,
+		const VulkanImage&	srcImage,
+		const VulkanImage&	dstImage,
+		VkExtent3D			srcExtent,
+		VkExtent3D			dstExtent
 	);
 
+	/**
+	 * @brief Fills mips 1..N-1 of every layer by successive blits from mip 0.
+	 * Only the mip pair of each step is synchronized; afterwards mips 0..N-2 are in
+	 * TRANSFER_SRC_OPTIMAL and the last one in TRANSFER_DST_OPTIMAL, as tracked on the image.
+	 */
+	void CmdGenerateMips(VkCommandBuffer cmdBuffer, VulkanImage& image);
+
+	/**
+	 * @brief Copies the top-left region of mip 0, layer 0 to host memory, rows tightly packed.
+	 * Blocks until the copy completed (CommandExecutor::Execute): meant for captures and image diffs, not per frame.
+	 * Handles the 8-bit and 16-bit float RGBA formats the renderer uses, returns nothing for others.
+	 */
+	[[nodiscard]] std::vector<uint8_t> Readback(VulkanImage& image, VkExtent2D region);
+
 }
\ No newline at end of file
@@ -2,47 +2,399 @@
 
 namespace tiny_vulkan::Synchronization {
 
-	void CmdImageMemoryBarrier(
-		VkCommandBuffer					cmdBuffer,
-		std::shared_ptr<VulkanImage>	image,
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+
+		// End of [offset, offset + size) clamped to the size the buffer was created with, size may be VK_WHOLE_SIZE.
+		// Ranges starting past the end yield end <= offset and record nothing.
+		VkDeviceSize ClampedEnd(const VulkanBuffer& buffer, VkDeviceSize offset, VkDeviceSize size)
+		{
+			const VkDeviceSize bufferSize = buffer.GetSize();
+			if (offset >= bufferSize)
+			{
+				return offset;
+			}
+			return size == VK_WHOLE_SIZE || size > bufferSize - offset ? bufferSize : offset + size;
+		}
+	}
+
+	bool IsWriteAccess(VkAccessFlags2 access)
+	{
+		constexpr VkAccessFlags2 writeMask =
+			VK_ACCESS_2_SHADER_WRITE_BIT |
+			VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+			VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+			VK_ACCESS_2_TRANSFER_WRITE_BIT |
+			VK_ACCESS_2_HOST_WRITE_BIT |
+			VK_ACCESS_2_MEMORY_WRITE_BIT;
+		return (access & writeMask) != 0;
+	}
+
+	VkImageSubresourceRange MakeRange(
+		VkImageAspectFlags	aspectMask,
+		uint32_t			baseMipLevel,
+		uint32_t			levelCount,
+		uint32_t			baseArrayLayer,
+		uint32_t			layerCount)
+	{
+		VkImageSubresourceRange range = {};
+		range.aspectMask = aspectMask;
+		range.baseMipLevel = baseMipLevel;
+		range.levelCount = levelCount;
+		range.baseArrayLayer = baseArrayLayer;
+		range.layerCount = layerCount;
+		return range;
+	}
+
+	// ========================================================
+	// BarrierBatch
+	// ========================================================
+	BarrierBatch& BarrierBatch::ImageBarrier(
+		VulkanImage&					image,
 		VkPipelineStageFlags2			dstStage,
 		VkAccessFlags2					dstAccess,
 		VkImageLayout					newLayout,
-		VkImageAspectFlags				aspectMask)
+		const VkImageSubresourceRange&	range)
+	{
+		const uint32_t mipEnd = range.levelCount == VK_REMAINING_MIP_LEVELS ? image.GetMipLevels() : range.baseMipLevel + range.levelCount;
+		const uint32_t layerEnd = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? image.GetArrayLayers() : range.baseArrayLayer + range.layerCount;
+		const ImageSyncState dst{ dstStage, dstAccess, newLayout };
+		const size_t firstOfImage = m_ImageBarriers.size();
+
+		for (uint32_t layer = range.baseArrayLayer; layer < layerEnd; ++layer)
+		{
+			uint32_t mip = range.baseMipLevel;
+			while (mip < mipEnd)
+			{
+				// Run of consecutive mips in the same state
+				const ImageSyncState src = image.GetSyncState(mip, layer);
+				uint32_t runEnd = mip + 1;
+				while (runEnd < mipEnd && image.GetSyncState(runEnd, layer) == src)
+				{
+					++runEnd;
+				}
+
+				ImageSyncState next = dst;
+				if (src.lastLayout == newLayout && !IsWriteAccess(src.lastAccess) && !IsWriteAccess(dstAccess))
+				{
+					next = { src.lastStage | dstStage, src.lastAccess | dstAccess, newLayout };
+				}
+				else
+				{
+					AddImageBarrier(firstOfImage, image.GetRaw(), src, dst, range.aspectMask, mip, runEnd - mip, layer);
+				}
+
+				for (; mip < runEnd; ++mip)
+				{
+					image.SetSyncState(mip, layer, next);
+				}
+			}
+		}
+
+		return *this;
+	}
+
+	void BarrierBatch::AddImageBarrier(size_t firstOfImage, VkImage image, const ImageSyncState& src, const ImageSyncState& dst,
+		VkImageAspectFlags aspectMask, uint32_t baseMip, uint32_t mipCount, uint32_t layer)
 	{
-		auto& syncState = image->GetSyncState();
+		// Same mips in the same state on the previous layer: extend that barrier instead
+		for (size_t i = firstOfImage; i < m_ImageBarriers.size(); ++i)
+		{
+			auto& barrier = m_ImageBarriers[i];
+			const auto& barrierRange = barrier.subresourceRange;
+			if (barrierRange.baseMipLevel == baseMip &&
+				barrierRange.levelCount == mipCount &&
+				barrierRange.baseArrayLayer + barrierRange.layerCount == layer &&
+				barrier.srcStageMask == src.lastStage &&
+				barrier.srcAccessMask == src.lastAccess &&
+				barrier.oldLayout == src.lastLayout)
+			{
+				++barrier.subresourceRange.layerCount;
+				return;
+			}
+		}
 
-		VkImageMemoryBarrier2 imageBarrier = {};
-		imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-		imageBarrier.pNext = nullptr;
+		VkImageMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
 
-		// Source: Current state of the image
-		imageBarrier.srcStageMask = syncState.lastStage;
-		imageBarrier.srcAccessMask = syncState.lastAccess;
-		imageBarrier.oldLayout = syncState.lastLayout;
+		// Source: Current state of the subresources
+		barrier.srcStageMask = src.lastStage;
+		barrier.srcAccessMask = src.lastAccess;
+		barrier.oldLayout = src.lastLayout;
 
 		// Destination: Target state
-		imageBarrier.dstStageMask = dstStage;
-		imageBarrier.dstAccessMask = dstAccess;
-		imageBarrier.newLayout = newLayout;
-
-		// Target Image
-		imageBarrier.image = image->GetRaw();
-		imageBarrier.subresourceRange.aspectMask = aspectMask;
-		imageBarrier.subresourceRange.baseArrayLayer = 0;
-		imageBarrier.subresourceRange.baseMipLevel = 0;
-		imageBarrier.subresourceRange.layerCount = 1;
-		imageBarrier.subresourceRange.levelCount = 1;
-
-		VkDependencyInfo depInfo = {};
-		depInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
-		depInfo.imageMemoryBarrierCount = 1;
-		depInfo.pImageMemoryBarriers = &imageBarrier;
+		barrier.dstStageMask = dst.lastStage;
+		barrier.dstAccessMask = dst.lastAccess;
+		barrier.newLayout = dst.lastLayout;
+
+		barrier.image = image;
+		barrier.subresourceRange = MakeRange(aspectMask, baseMip, mipCount, layer, 1);
+		m_ImageBarriers.push_back(barrier);
+	}
+
+	BarrierBatch& BarrierBatch::BufferBarrier(
+		VulkanBuffer&					buffer,
+		VkPipelineStageFlags2			dstStage,
+		VkAccessFlags2					dstAccess,
+		VkDeviceSize					offset,
+		VkDeviceSize					size)
+	{
+		const VkDeviceSize end = ClampedEnd(buffer, offset, size);
+		if (offset >= end)
+		{
+			return *this;
+		}
+
+		const size_t firstOfBuffer = m_BufferBarriers.size();
+
+		// Tracked ranges are updated once the overlapping ones are all visited
+		std::vector<BufferRangeState> updates;
+		for (const auto& range : buffer.GetSyncStates())
+		{
+			const VkDeviceSize begin = std::max(range.offset, offset);
+			const VkDeviceSize rangeEnd = std::min(range.offset + range.size, end);
+			if (begin >= rangeEnd)
+			{
+				continue;
+			}
+
+			const BufferSyncState& src = range.state;
+			BufferSyncState next{ dstStage, dstAccess };
+			if (src.lastStage == VK_PIPELINE_STAGE_2_NONE || (!IsWriteAccess(src.lastAccess) && !IsWriteAccess(dstAccess)))
+			{
+				// Nothing to wait for, or read after read
+				next = { src.lastStage | dstStage, src.lastAccess | dstAccess };
+			}
+			else if (m_BufferBarriers.size() > firstOfBuffer &&
+				m_BufferBarriers.back().offset + m_BufferBarriers.back().size == begin &&
+				m_BufferBarriers.back().srcStageMask == src.lastStage &&
+				m_BufferBarriers.back().srcAccessMask == src.lastAccess)
+			{
+				m_BufferBarriers.back().size += rangeEnd - begin;
+			}
+			else
+			{
+				VkBufferMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
+				barrier.srcStageMask = src.lastStage;
+				barrier.srcAccessMask = src.lastAccess;
+				barrier.dstStageMask = dstStage;
+				barrier.dstAccessMask = dstAccess;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.buffer = buffer.GetRaw();
+				barrier.offset = begin;
+				barrier.size = rangeEnd - begin;
+				m_BufferBarriers.push_back(barrier);
+			}
+
+			updates.push_back(BufferRangeState{ .offset = begin, .size = rangeEnd - begin, .state = next });
+		}
+
+		for (const auto& update : updates)
+		{
+			buffer.SetSyncState(update.offset, update.size, update.state);
+		}
+
+		return *this;
+	}
+
+	// ========================================================
+	// Queue family ownership transfers
+	// ========================================================
+	BarrierBatch& BarrierBatch::ReleaseImage(
+		VulkanImage&					image,
+		VkImageLayout					newLayout,
+		uint32_t						srcFamily,
+		uint32_t						dstFamily,
+		const VkImageSubresourceRange&	range)
+	{
+		if (srcFamily != dstFamily)
+		{
+			AddOwnershipBarriers(image, false, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, newLayout, srcFamily, dstFamily, range);
+		}
+		return *this;
+	}
+
+	BarrierBatch& BarrierBatch::AcquireImage(
+		VulkanImage&					image,
+		VkPipelineStageFlags2			dstStage,
+		VkAccessFlags2					dstAccess,
+		VkImageLayout					newLayout,
+		uint32_t						srcFamily,
+		uint32_t						dstFamily,
+		const VkImageSubresourceRange&	range)
+	{
+		if (srcFamily == dstFamily)
+		{
+			return ImageBarrier(image, dstStage, dstAccess, newLayout, range);
+		}
+
+		AddOwnershipBarriers(image, true, dstStage, dstAccess, newLayout, srcFamily, dstFamily, range);
+		return *this;
+	}
+
+	void BarrierBatch::AddOwnershipBarriers(VulkanImage& image, bool acquire, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess,
+		VkImageLayout newLayout, uint32_t srcFamily, uint32_t dstFamily, const VkImageSubresourceRange& range)
+	{
+		const uint32_t mipEnd = range.levelCount == VK_REMAINING_MIP_LEVELS ? image.GetMipLevels() : range.baseMipLevel + range.levelCount;
+		const uint32_t layerEnd = range.layerCount == VK_REMAINING_ARRAY_LAYERS ? image.GetArrayLayers() : range.baseArrayLayer + range.layerCount;
+
+		for (uint32_t layer = range.baseArrayLayer; layer < layerEnd; ++layer)
+		{
+			uint32_t mip = range.baseMipLevel;
+			while (mip < mipEnd)
+			{
+				const ImageSyncState src = image.GetSyncState(mip, layer);
+				uint32_t runEnd = mip + 1;
+				while (runEnd < mipEnd && image.GetSyncState(runEnd, layer) == src)
+				{
+					++runEnd;
+				}
+
+				// The release keeps the old layout tracked: the acquire has to repeat the same transition.
+				// The semaphore between the halves orders them, the acquire has no source scope.
+				VkImageMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+				barrier.srcStageMask = acquire ? VK_PIPELINE_STAGE_2_NONE : src.lastStage;
+				barrier.srcAccessMask = acquire ? VK_ACCESS_2_NONE : src.lastAccess;
+				barrier.dstStageMask = dstStage;
+				barrier.dstAccessMask = dstAccess;
+				barrier.oldLayout = src.lastLayout;
+				barrier.newLayout = newLayout;
+				barrier.srcQueueFamilyIndex = srcFamily;
+				barrier.dstQueueFamilyIndex = dstFamily;
+				barrier.image = image.GetRaw();
+				barrier.subresourceRange = MakeRange(range.aspectMask, mip, runEnd - mip, layer, 1);
+				m_ImageBarriers.push_back(barrier);
+
+				const ImageSyncState next = acquire
+					? ImageSyncState{ dstStage, dstAccess, newLayout }
+					: ImageSyncState{ VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, src.lastLayout };
+				for (; mip < runEnd; ++mip)
+				{
+					image.SetSyncState(mip, layer, next);
+				}
+			}
+		}
+	}
+
+	BarrierBatch& BarrierBatch::ReleaseBuffer(
+		VulkanBuffer&					buffer,
+		uint32_t						srcFamily,
+		uint32_t						dstFamily,
+		VkDeviceSize					offset,
+		VkDeviceSize					size)
+	{
+		if (srcFamily == dstFamily)
+		{
+			return *this;
+		}
+
+		const VkDeviceSize end = ClampedEnd(buffer, offset, size);
+		if (offset >= end)
+		{
+			return *this;
+		}
+
+		// One barrier for the range, waiting for every access made to any part of it
+		VkBufferMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
+		for (const auto& range : buffer.GetSyncStates())
+		{
+			if (std::max(range.offset, offset) < std::min(range.offset + range.size, end))
+			{
+				barrier.srcStageMask |= range.state.lastStage;
+				barrier.srcAccessMask |= range.state.lastAccess;
+			}
+		}
+		barrier.srcQueueFamilyIndex = srcFamily;
+		barrier.dstQueueFamilyIndex = dstFamily;
+		barrier.buffer = buffer.GetRaw();
+		barrier.offset = offset;
+		barrier.size = end - offset;
+		m_BufferBarriers.push_back(barrier);
+
+		buffer.SetSyncState(offset, end - offset, BufferSyncState{ VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE });
+		return *this;
+	}
+
+	BarrierBatch& BarrierBatch::AcquireBuffer(
+		VulkanBuffer&					buffer,
+		VkPipelineStageFlags2			dstStage,
+		VkAccessFlags2					dstAccess,
+		uint32_t						srcFamily,
+		uint32_t						dstFamily,
+		VkDeviceSize					offset,
+		VkDeviceSize					size)
+	{
+		if (srcFamily == dstFamily)
+		{
+			return BufferBarrier(buffer, dstStage, dstAccess, offset, size);
+		}
+
+		const VkDeviceSize end = ClampedEnd(buffer, offset, size);
+		if (offset >= end)
+		{
+			return *this;
+		}
+
+		VkBufferMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.srcQueueFamilyIndex = srcFamily;
+		barrier.dstQueueFamilyIndex = dstFamily;
+		barrier.buffer = buffer.GetRaw();
+		barrier.offset = offset;
+		barrier.size = end - offset;
+		m_BufferBarriers.push_back(barrier);
 
+		buffer.SetSyncState(offset, end - offset, BufferSyncState{ dstStage, dstAccess });
+		return *this;
+	}
+
+	void BarrierBatch::Flush(VkCommandBuffer cmdBuffer)
+	{
+		if (IsEmpty())
+		{
+			return;
+		}
+
+		VkDependencyInfo depInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+		depInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(m_BufferBarriers.size());
+		depInfo.pBufferMemoryBarriers = m_BufferBarriers.data();
+		depInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_ImageBarriers.size());
+		depInfo.pImageMemoryBarriers = m_ImageBarriers.data();
 		vkCmdPipelineBarrier2(cmdBuffer, &depInfo);
 
-		// Update the internal state tracker so the next barrier knows where to start
-		image->SetSyncState(dstStage, dstAccess, newLayout);
+		m_BufferBarriers.clear();
+		m_ImageBarriers.clear();
+	}
+
+	// ========================================================
+	// Single barrier
+	// ========================================================
+	void CmdImageMemoryBarrier(
+		VkCommandBuffer					cmdBuffer,
+		std::shared_ptr<VulkanImage>	image,
+		VkPipelineStageFlags2			dstStage,
+		VkAccessFlags2					dstAccess,
+		VkImageLayout					newLayout,
+		VkImageAspectFlags				aspectMask)
+	{
+		BarrierBatch batch;
+		batch.ImageBarrier(*image, dstStage, dstAccess, newLayout, MakeRange(aspectMask));
+		batch.Flush(cmdBuffer);
+	}
+
+	void CmdBufferMemoryBarrier(
+		VkCommandBuffer					cmdBuffer,
+		VulkanBuffer&					buffer,
+		VkPipelineStageFlags2			dstStage,
+		VkAccessFlags2					dstAccess,
+		VkDeviceSize					offset,
+		VkDeviceSize					size)
+	{
+		BarrierBatch batch;
+		batch.BufferBarrier(buffer, dstStage, dstAccess, offset, size);
+		batch.Flush(cmdBuffer);
 	}
 
-}
\ No newline at end of file
+}
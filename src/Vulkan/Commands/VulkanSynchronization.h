@@ -1,15 +1,117 @@
 #pragma once
 
 #include "VulkanImage.h"
+#include "VulkanBuffer.h"
 
 #include <memory>
+#include <vector>
 #include <vulkan/vulkan.h>
 
 namespace tiny_vulkan::Synchronization {
 
+	[[nodiscard]] bool IsWriteAccess(VkAccessFlags2 access);
+
+	// Subresource range, the whole image by default.
+	[[nodiscard]] VkImageSubresourceRange MakeRange(
+		VkImageAspectFlags	aspectMask,
+		uint32_t			baseMipLevel = 0,
+		uint32_t			levelCount = VK_REMAINING_MIP_LEVELS,
+		uint32_t			baseArrayLayer = 0,
+		uint32_t			layerCount = VK_REMAINING_ARRAY_LAYERS
+	);
+
+	/**
+	 * @brief Collects image and buffer barriers and records them with a single vkCmdPipelineBarrier2.
+	 * Sources come from the tracked state of each subresource (or buffer range): mips, layers or ranges
+	 * in different states get their own barrier, neighbours in the same state share one. Read-after-read
+	 * in the same layout records nothing and widens the tracked state instead, so the next writer waits for every reader.
+	 * A subresource or byte may be synchronized only once per batch.
+	 */
+	class BarrierBatch
+	{
+	public:
+		BarrierBatch() = default;
+
+		BarrierBatch& ImageBarrier(
+			VulkanImage&					image,
+			VkPipelineStageFlags2			dstStage,
+			VkAccessFlags2					dstAccess,
+			VkImageLayout					newLayout,
+			const VkImageSubresourceRange&	range
+		);
+
+		// Ranges never accessed before need no barrier.
+		BarrierBatch& BufferBarrier(
+			VulkanBuffer&					buffer,
+			VkPipelineStageFlags2			dstStage,
+			VkAccessFlags2					dstAccess,
+			VkDeviceSize					offset = 0,
+			VkDeviceSize					size = VK_WHOLE_SIZE
+		);
+
+		/**
+		 * Queue family ownership transfer of an exclusive resource, in two halves recorded on each queue:
+		 * Release in the source queue's command buffer, then Acquire in the destination's, ordered by a semaphore.
+		 * Both halves take the same newLayout (the transition happens once), the source state comes from tracking.
+		 * With equal families there is nothing to transfer: Release records nothing and Acquire is a plain barrier.
+		 */
+		BarrierBatch& ReleaseImage(
+			VulkanImage&					image,
+			VkImageLayout					newLayout,
+			uint32_t						srcFamily,
+			uint32_t						dstFamily,
+			const VkImageSubresourceRange&	range
+		);
+
+		BarrierBatch& AcquireImage(
+			VulkanImage&					image,
+			VkPipelineStageFlags2			dstStage,
+			VkAccessFlags2					dstAccess,
+			VkImageLayout					newLayout,
+			uint32_t						srcFamily,
+			uint32_t						dstFamily,
+			const VkImageSubresourceRange&	range
+		);
+
+		BarrierBatch& ReleaseBuffer(
+			VulkanBuffer&					buffer,
+			uint32_t						srcFamily,
+			uint32_t						dstFamily,
+			VkDeviceSize					offset = 0,
+			VkDeviceSize					size = VK_WHOLE_SIZE
+		);
+
+		BarrierBatch& AcquireBuffer(
+			VulkanBuffer&					buffer,
+			VkPipelineStageFlags2			dstStage,
+			VkAccessFlags2					dstAccess,
+			uint32_t						srcFamily,
+			uint32_t						dstFamily,
+			VkDeviceSize					offset = 0,
+			VkDeviceSize					size = VK_WHOLE_SIZE
+		);
+
+		void Flush(VkCommandBuffer cmdBuffer);
+
+		[[nodiscard]] bool		IsEmpty()			const { return m_ImageBarriers.empty() && m_BufferBarriers.empty(); }
+		[[nodiscard]] uint32_t	GetBarrierCount()	const { return static_cast<uint32_t>(m_ImageBarriers.size() + m_BufferBarriers.size()); }
+
+	private:
+		void AddImageBarrier(size_t firstOfImage, VkImage image, const ImageSyncState& src, const ImageSyncState& dst,
+			VkImageAspectFlags aspectMask, uint32_t baseMip, uint32_t mipCount, uint32_t layer);
+
+		// One barrier per run of mips in the same state, with the transfer's queue families
+		void AddOwnershipBarriers(VulkanImage& image, bool acquire, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess,
+			VkImageLayout newLayout, uint32_t srcFamily, uint32_t dstFamily, const VkImageSubresourceRange& range);
+
+	private:
+		std::vector<VkImageMemoryBarrier2>	m_ImageBarriers;
+		std::vector<VkBufferMemoryBarrier2>	m_BufferBarriers;
+	};
+
 	/**
 	 * @brief Records a pipeline barrier to transition image layout and sync access.
-	 * Updates the internal SyncState of the VulkanImage.
+	 * Covers every mip and layer of the aspect and updates their tracked sync state.
 	 */
 	void CmdImageMemoryBarrier(
 		VkCommandBuffer					cmdBuffer,
@@ -20,4 +122,17 @@ namespace tiny_vulkan::Synchronization {
 		VkImageAspectFlags				aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
 	);
 
-}
\ No newline at end of file
+	/**
+	 * @brief Records a pipeline barrier making [offset, offset + size) of the buffer available to dstStage/dstAccess.
+	 * Updates the tracked state of the range.
+	 */
+	void CmdBufferMemoryBarrier(
+		VkCommandBuffer					cmdBuffer,
+		VulkanBuffer&					buffer,
+		VkPipelineStageFlags2			dstStage,
+		VkAccessFlags2					dstAccess,
+		VkDeviceSize					offset = 0,
+		VkDeviceSize					size = VK_WHOLE_SIZE
+	);
+
+}
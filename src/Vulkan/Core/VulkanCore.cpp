@@ -1,6 +1,8 @@
 #include "VulkanCore.h"
+#include "VulkanExtensions.h"
 #include "Application.h"
 #include "LifetimeManager.h"
+#include "DeletionQueue.h"
 #include "LogSystem.h"
 
 #ifndef VMA_IMPLEMENTATION
@@ -23,42 +25,140 @@ namespace tiny_vulkan {
 	VkDevice                         VulkanCore::s_Device = VK_NULL_HANDLE;
 	VmaAllocator                     VulkanCore::s_Allocator = VK_NULL_HANDLE;
 	std::shared_ptr<VulkanSwapchain> VulkanCore::s_Swapchain = nullptr;
-	std::shared_ptr<VulkanImage>     VulkanCore::s_RenderTarget = nullptr;
-	std::shared_ptr<VulkanImage>	 VulkanCore::s_DepthImage = nullptr;
 	uint32_t						 VulkanCore::s_GraphicsFamilyIndex = 0;
 	uint32_t						 VulkanCore::s_PresentFamilyIndex = 0;
 	VkQueue							 VulkanCore::s_GraphicsQueue = VK_NULL_HANDLE;
 	VkQueue							 VulkanCore::s_PresentQueue = VK_NULL_HANDLE;
+	uint32_t						 VulkanCore::s_ComputeFamilyIndex = 0;
+	VkQueue							 VulkanCore::s_ComputeQueue = VK_NULL_HANDLE;
 
 	std::vector<std::shared_ptr<tiny_vulkan::VulkanFrame>> VulkanCore::s_Frames;
-	uint32_t VulkanCore::s_FlightFrameCount = 3;
+	uint32_t VulkanCore::s_FlightFrameCount = 0;
 	uint32_t VulkanCore::s_CurrentFrameIndex = 0;
-
-	void VulkanCore::Initialize(std::shared_ptr<Window> window)
+	uint64_t VulkanCore::s_FrameNumber = 1;
+	VkSemaphore VulkanCore::s_FrameTimeline = VK_NULL_HANDLE;
+	DeviceCapabilities VulkanCore::s_Capabilities = {};
+	RenderSettings VulkanCore::s_Settings = {};
+	VkExtent2D VulkanCore::s_HeadlessExtent = { 0, 0 };
+	bool VulkanCore::s_SurfaceMaintenance = false;
+
+	void VulkanCore::Initialize(std::shared_ptr<Window> window, const RenderSettings& settings)
 	{
 		s_Window = window;
+		ApplySettings(settings);
 
 		CreateInstance();
 		CreateSurface(s_Window->GetRaw());
 		SelectPhysicalDevice();
+		EnableOptionalFeatures();
 		CreateLogicalDevice();
 		CreateAllocator();
 		CreateSwapchain();
-		CreateRenderTarget();
-		CreateDepthImage();
+		CreateFrameTimeline();
+		CreateFrames();
+	}
+
+	void VulkanCore::InitializeHeadless(VkExtent2D extent, const RenderSettings& settings)
+	{
+		s_Window = nullptr;
+		s_HeadlessExtent = extent;
+		ApplySettings(settings);
+
+		CreateInstance();
+		SelectPhysicalDevice();
+		EnableOptionalFeatures();
+		CreateLogicalDevice();
+		CreateAllocator();
+		CreateFrameTimeline();
 		CreateFrames();
+
+		LOG_INFO(fmt::runtime("Headless mode: rendering offscreen at {0}x{1}"), extent.width, extent.height);
+	}
+
+	void VulkanCore::ApplySettings(const RenderSettings& settings)
+	{
+		s_Settings = settings;
+
+		constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+		if (s_Settings.framesInFlight < 1 || s_Settings.framesInFlight > MAX_FRAMES_IN_FLIGHT)
+		{
+			LOG_WARN(fmt::runtime("{0} frames in flight requested, clamped to [1, {1}]"), s_Settings.framesInFlight, MAX_FRAMES_IN_FLIGHT);
+			s_Settings.framesInFlight = std::clamp(s_Settings.framesInFlight, 1u, MAX_FRAMES_IN_FLIGHT);
+		}
+		s_FlightFrameCount = s_Settings.framesInFlight;
+		s_Settings.minRenderScale = std::clamp(s_Settings.minRenderScale, 0.25f, 1.0f);
+
+		// The budget divides the measured GPU time, zero or negative would drive the scale to its bounds
+		constexpr float MIN_GPU_BUDGET_MS = 1.0f;
+		if (!(s_Settings.gpuBudgetMs >= MIN_GPU_BUDGET_MS))
+		{
+			LOG_WARN(fmt::runtime("GPU budget of {0} ms requested, clamped to {1} ms"), s_Settings.gpuBudgetMs, MIN_GPU_BUDGET_MS);
+			s_Settings.gpuBudgetMs = MIN_GPU_BUDGET_MS;
+		}
+
+		// Nothing is presented headless: the frame ends in the render target
+		if (IsHeadless() && (s_Settings.directToSwapchain || s_Settings.lowLatency))
+		{
+			LOG_WARN("Direct-to-swapchain and low-latency modes need a swapchain, disabled in headless mode");
+			s_Settings.directToSwapchain = false;
+			s_Settings.lowLatency = false;
+		}
+		if (s_Settings.directToSwapchain && s_Settings.dynamicResolution)
+		{
+			LOG_WARN("Dynamic resolution needs the intermediate render target, disabled in direct-to-swapchain mode");
+			s_Settings.dynamicResolution = false;
+		}
 	}
 
 	void VulkanCore::AdvanceFrame()
 	{
 		s_CurrentFrameIndex = (s_CurrentFrameIndex + 1) % s_FlightFrameCount;
+		++s_FrameNumber;
+
+		// The previous frame is submitted: anything retired from now on may be in use until this one completes
+		DeletionQueue::SetCurrentFrame(s_FrameNumber);
+	}
+
+	VkExtent2D VulkanCore::GetOutputExtent()
+	{
+		return s_Swapchain ? s_Swapchain->GetExtent() : s_HeadlessExtent;
+	}
+
+	uint64_t VulkanCore::GetCompletedFrame()
+	{
+		uint64_t value = 0;
+		CHECK_VK_RES(vkGetSemaphoreCounterValue(s_Device, s_FrameTimeline, &value));
+		return value;
+	}
+
+	void VulkanCore::WaitForFrame(uint64_t frameNumber)
+	{
+		VkSemaphoreWaitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &s_FrameTimeline;
+		waitInfo.pValues = &frameNumber;
+		CHECK_VK_RES(vkWaitSemaphores(s_Device, &waitInfo, UINT64_MAX));
 	}
 
 	void VulkanCore::CreateInstance()
 	{
 		vkb::InstanceBuilder instanceBuilder;
+
+		// Needed by VK_EXT_swapchain_maintenance1 on the device
+		auto systemInfo = vkb::SystemInfo::get_system_info();
+		if (!IsHeadless() && systemInfo &&
+			systemInfo->is_extension_available(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME) &&
+			systemInfo->is_extension_available(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME))
+		{
+			instanceBuilder
+				.enable_extension(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME)
+				.enable_extension(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+			s_SurfaceMaintenance = true;
+		}
+
 		s_VkbInstance = instanceBuilder
 			.set_app_name("Tiny Vulkan")
+			.set_headless(IsHeadless())
 			.request_validation_layers(false)
 			.use_default_debug_messenger()
 			.require_api_version(1, 4, 0)
@@ -89,15 +189,19 @@ namespace tiny_vulkan {
 		features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 		features12.bufferDeviceAddress = true;
 		features12.descriptorIndexing = true;
+		features12.timelineSemaphore = true;
 
 		vkb::PhysicalDeviceSelector selector{ s_VkbInstance };
-		s_VkbPhysicalDevice = selector
+		selector
 			.set_minimum_version(1, 4)
 			.set_required_features_13(features13)
 			.set_required_features_12(features12)
-			.set_surface(s_Surface)
-			.select()
-			.value();
+			.require_present(!IsHeadless());
+		if (!IsHeadless())
+		{
+			selector.set_surface(s_Surface);
+		}
+		s_VkbPhysicalDevice = selector.select().value();
 
 		s_PhysicalDevice = s_VkbPhysicalDevice.physical_device;
 
@@ -110,6 +214,132 @@ namespace tiny_vulkan {
 		);
 	}
 
+	void VulkanCore::EnableOptionalFeatures()
+	{
+		// ========================================================
+		// Graphics pipeline library (split pipeline compilation)
+		// ========================================================
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT gplFeatures = {};
+		gplFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+		gplFeatures.graphicsPipelineLibrary = VK_TRUE;
+
+		if (s_VkbPhysicalDevice.is_extension_present(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+			s_VkbPhysicalDevice.is_extension_present(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+			s_VkbPhysicalDevice.enable_extension_features_if_present(gplFeatures))
+		{
+			s_VkbPhysicalDevice.enable_extension_if_present(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+			s_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+
+			VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT gplProps = {};
+			gplProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+
+			VkPhysicalDeviceProperties2 props2 = {};
+			props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			props2.pNext = &gplProps;
+			vkGetPhysicalDeviceProperties2(s_PhysicalDevice, &props2);
+
+			s_Capabilities.graphicsPipelineLibrary = true;
+			s_Capabilities.graphicsPipelineLibraryFastLinking = gplProps.graphicsPipelineLibraryFastLinking == VK_TRUE;
+		}
+
+		// ========================================================
+		// Extended dynamic state 3 (blend and polygon mode as command buffer state)
+		// ========================================================
+		if (s_VkbPhysicalDevice.is_extension_present(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+		{
+			VkPhysicalDeviceExtendedDynamicState3FeaturesEXT supported = {};
+			supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+			VkPhysicalDeviceFeatures2 features2 = {};
+			features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features2.pNext = &supported;
+			vkGetPhysicalDeviceFeatures2(s_PhysicalDevice, &features2);
+
+			const bool blendSupported =
+				supported.extendedDynamicState3ColorBlendEnable &&
+				supported.extendedDynamicState3ColorBlendEquation &&
+				supported.extendedDynamicState3ColorWriteMask;
+
+			// Request only the subset the renderer uses and the device has
+			VkPhysicalDeviceExtendedDynamicState3FeaturesEXT eds3Features = {};
+			eds3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+			eds3Features.extendedDynamicState3ColorBlendEnable = blendSupported;
+			eds3Features.extendedDynamicState3ColorBlendEquation = blendSupported;
+			eds3Features.extendedDynamicState3ColorWriteMask = blendSupported;
+			eds3Features.extendedDynamicState3PolygonMode = supported.extendedDynamicState3PolygonMode;
+
+			if ((blendSupported || supported.extendedDynamicState3PolygonMode) &&
+				s_VkbPhysicalDevice.enable_extension_features_if_present(eds3Features))
+			{
+				s_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+
+				s_Capabilities.dynamicBlendState = blendSupported;
+				s_Capabilities.dynamicPolygonMode = supported.extendedDynamicState3PolygonMode == VK_TRUE;
+			}
+		}
+
+		// ========================================================
+		// Shader objects (pipeline-less shader binding)
+		// ========================================================
+		VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures = {};
+		shaderObjectFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+		shaderObjectFeatures.shaderObject = VK_TRUE;
+
+		if (s_VkbPhysicalDevice.is_extension_present(VK_EXT_SHADER_OBJECT_EXTENSION_NAME) &&
+			s_VkbPhysicalDevice.enable_extension_features_if_present(shaderObjectFeatures))
+		{
+			s_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+			s_Capabilities.shaderObject = true;
+		}
+
+		// ========================================================
+		// Swapchain maintenance (present fences, for retiring swapchains)
+		// ========================================================
+		VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchainMaintenanceFeatures = {};
+		swapchainMaintenanceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT;
+		swapchainMaintenanceFeatures.swapchainMaintenance1 = VK_TRUE;
+
+		if (s_SurfaceMaintenance &&
+			s_VkbPhysicalDevice.is_extension_present(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME) &&
+			s_VkbPhysicalDevice.enable_extension_features_if_present(swapchainMaintenanceFeatures))
+		{
+			s_VkbPhysicalDevice.enable_extension_if_present(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+			s_Capabilities.swapchainMaintenance = true;
+		}
+
+		// ========================================================
+		// Present wait (block the CPU until a given present reached the display)
+		// ========================================================
+		VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+		presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+		presentIdFeatures.presentId = VK_TRUE;
+
+		VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+		presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+		presentWaitFeatures.presentWait = VK_TRUE;
+
+		if (!IsHeadless() &&
+			s_VkbPhysicalDevice.is_extension_present(VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+			s_VkbPhysicalDevice.is_extension_present(VK_KHR_PRESENT_WAIT_EXTENSION_NAME) &&
+			s_VkbPhysicalDevice.enable_extension_features_if_present(presentIdFeatures) &&
+			s_VkbPhysicalDevice.enable_extension_features_if_present(presentWaitFeatures))
+		{
+			s_VkbPhysicalDevice.enable_extension_if_present(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+			s_VkbPhysicalDevice.enable_extension_if_present(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+			s_Capabilities.presentWait = true;
+		}
+
+		LOG_INFO(fmt::runtime("Optional features: \n\t->Graphics pipeline library: {0} (fast linking: {1}) \n\t->Dynamic blend state: {2} \n\t->Dynamic polygon mode: {3} \n\t->Shader object: {4} \n\t->Present wait: {5} \n\t->Swapchain maintenance: {6}"),
+			s_Capabilities.graphicsPipelineLibrary,
+			s_Capabilities.graphicsPipelineLibraryFastLinking,
+			s_Capabilities.dynamicBlendState,
+			s_Capabilities.dynamicPolygonMode,
+			s_Capabilities.shaderObject,
+			s_Capabilities.presentWait,
+			s_Capabilities.swapchainMaintenance
+		);
+	}
+
 	void VulkanCore::CreateLogicalDevice()
 	{
 		vkb::DeviceBuilder deviceBuilder{ s_VkbPhysicalDevice };
@@ -117,9 +347,30 @@ namespace tiny_vulkan {
 
 		s_Device = vkbDevice.device;
 		s_GraphicsFamilyIndex = vkbDevice.get_queue_index(vkb::QueueType::graphics).value();
-		s_PresentFamilyIndex = vkbDevice.get_queue_index(vkb::QueueType::present).value();
 		s_GraphicsQueue = vkbDevice.get_queue(vkb::QueueType::graphics).value();
-		s_PresentQueue = vkbDevice.get_queue(vkb::QueueType::present).value();
+		if (!IsHeadless())
+		{
+			s_PresentFamilyIndex = vkbDevice.get_queue_index(vkb::QueueType::present).value();
+			s_PresentQueue = vkbDevice.get_queue(vkb::QueueType::present).value();
+		}
+
+		// A family without graphics runs compute alongside the raster work, otherwise compute shares the graphics queue.
+		// Separate, not dedicated: the async compute families of desktop GPUs also support transfer.
+		auto computeFamily = vkbDevice.get_separate_queue_index(vkb::QueueType::compute);
+		if (s_Settings.asyncCompute && computeFamily.has_value())
+		{
+			s_ComputeFamilyIndex = computeFamily.value();
+			s_ComputeQueue = vkbDevice.get_separate_queue(vkb::QueueType::compute).value();
+			s_Capabilities.asyncCompute = true;
+		}
+		else
+		{
+			s_ComputeFamilyIndex = s_GraphicsFamilyIndex;
+			s_ComputeQueue = s_GraphicsQueue;
+		}
+		LOG_INFO(fmt::runtime("Compute queue: family {0} ({1})"), s_ComputeFamilyIndex, s_Capabilities.asyncCompute ? "async" : "shared with graphics");
+
+		Extensions::Load(s_Device);
 
 		LifetimeManager::PushFunction(vkDestroyDevice, s_Device, nullptr);
 	}
@@ -134,124 +385,34 @@ namespace tiny_vulkan {
 
 		CHECK_VK_RES(vmaCreateAllocator(&allocatorInfo, &s_Allocator));
 		LifetimeManager::PushFunction(vmaDestroyAllocator, s_Allocator);
+
+		// Runs after every cleanup registered later (LIFO), so whatever they retire is
+		// released before the allocator and the device go away.
+		LifetimeManager::PushFunction(DeletionQueue::FlushAll);
 	}
 
 	void VulkanCore::CreateSwapchain()
 	{
 		s_Swapchain = std::make_shared<VulkanSwapchain>(
 			s_Window->GetWidth(),
-			s_Window->GetHeight()
+			s_Window->GetHeight(),
+			s_Settings.presentMode
 		);
 	}
 
-	void VulkanCore::CreateRenderTarget()
+	void VulkanCore::CreateFrameTimeline()
 	{
-		// Settings
-		const VkFormat format = VK_FORMAT_R16G16B16A16_SFLOAT;
-		const VkExtent3D extent = s_Swapchain->GetImages()[0]->GetExtent();
-
-		// Image Info
-		VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
-		imageInfo.imageType = VK_IMAGE_TYPE_2D;
-		imageInfo.format = format;
-		imageInfo.extent = extent;
-		imageInfo.mipLevels = 1;
-		imageInfo.arrayLayers = 1;
-		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-		imageInfo.usage =
-			VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
-			VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-			VK_IMAGE_USAGE_STORAGE_BIT |
-			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-		// Allocation Info
-		VmaAllocationCreateInfo allocInfo = {};
-		allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
-		allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
-		allocInfo.priority = 1.0f;
-
-		// Create image
-		VkImage image{ VK_NULL_HANDLE };
-		VmaAllocation allocation{ VK_NULL_HANDLE };
-		CHECK_VK_RES(vmaCreateImage(s_Allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr));
-
-		// View Info
-		VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
-		viewInfo.image = image;
-		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-		viewInfo.format = format;
-		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		viewInfo.subresourceRange.levelCount = 1;
-		viewInfo.subresourceRange.layerCount = 1;
-		viewInfo.subresourceRange.baseArrayLayer = 0;
-		viewInfo.subresourceRange.baseMipLevel = 0;
-
-		VkImageView view{ VK_NULL_HANDLE };
-		CHECK_VK_RES(vkCreateImageView(s_Device, &viewInfo, nullptr, &view));
-
-		// Store result
-		s_RenderTarget = std::make_shared<VulkanImage>(image, view, format, extent, allocation);
-
-		// Cleanup
-		LifetimeManager::PushFunction(vmaDestroyImage, s_Allocator, image, allocation);
-		LifetimeManager::PushFunction(vkDestroyImageView, s_Device, view, nullptr);
-	}
+		// One device timeline paces the frames, deferred deletion and uploads.
+		// 0 means nothing completed yet, frame numbers start at 1.
+		VkSemaphoreTypeCreateInfo typeInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
 
-	void VulkanCore::CreateDepthImage()
-	{
-		VkExtent3D depthExtent = s_RenderTarget->GetExtent();
-		VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
-
-		VkImageCreateInfo depthInfo = {};
-		depthInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-		depthInfo.pNext = nullptr;
-		depthInfo.flags = 0;
-		depthInfo.imageType = VK_IMAGE_TYPE_2D;
-		depthInfo.format = depthFormat;
-		depthInfo.extent = depthExtent;
-		depthInfo.mipLevels = 1;
-		depthInfo.arrayLayers = 1;
-		depthInfo.samples = VK_SAMPLE_COUNT_1_BIT;	
-		depthInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-		depthInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-		depthInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		depthInfo.queueFamilyIndexCount = 0;
-		depthInfo.pQueueFamilyIndices = nullptr;
-		depthInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-
-		VmaAllocationCreateInfo allocationInfo = {};
-		allocationInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-		allocationInfo.requiredFlags = VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-		VkImage depthImage{ VK_NULL_HANDLE };
-		VkImageView depthView{ VK_NULL_HANDLE };
-		VmaAllocation allocation{ VK_NULL_HANDLE };
-		vmaCreateImage(s_Allocator, &depthInfo, &allocationInfo, &depthImage, &allocation, nullptr);
-
-		VkImageViewCreateInfo depthViewInfo = {};
-		depthViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		depthViewInfo.pNext = nullptr;
-		depthViewInfo.flags = 0;
-		depthViewInfo.image = depthImage;
-		depthViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-		depthViewInfo.format = depthFormat;
-		depthViewInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-		depthViewInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-		depthViewInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-		depthViewInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-		depthViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-		depthViewInfo.subresourceRange.baseArrayLayer = 0;
-		depthViewInfo.subresourceRange.baseMipLevel = 0;
-		depthViewInfo.subresourceRange.layerCount = 1;
-		depthViewInfo.subresourceRange.levelCount = 1;
-		CHECK_VK_RES(vkCreateImageView(s_Device, &depthViewInfo, nullptr, &depthView));
-
-		s_DepthImage = std::make_shared<VulkanImage>(depthImage, depthView, depthFormat, depthExtent, allocation);
-
-		LifetimeManager::PushFunction(vmaDestroyImage, s_Allocator, depthImage, allocation);
-		LifetimeManager::PushFunction(vkDestroyImageView, s_Device, depthView, nullptr);
+		VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		semaphoreInfo.pNext = &typeInfo;
+		CHECK_VK_RES(vkCreateSemaphore(s_Device, &semaphoreInfo, nullptr, &s_FrameTimeline));
+
+		LifetimeManager::PushFunction(vkDestroySemaphore, s_Device, s_FrameTimeline, nullptr);
 	}
 
 	void VulkanCore::CreateFrames()
@@ -3,7 +3,6 @@
 #include "Window.h"
 #include "VulkanFrame.h"
 #include "VulkanSwapchain.h"
-#include "VulkanImage.h"
 #include "VkBootstrap.h"
 
 #include <memory>
@@ -12,6 +11,41 @@
 
 namespace tiny_vulkan {
 
+	// Optional device features, detected at startup and enabled only when the GPU exposes them.
+	struct DeviceCapabilities
+	{
+		bool graphicsPipelineLibrary{ false };
+		bool graphicsPipelineLibraryFastLinking{ false };
+		bool dynamicBlendState{ false };	// VK_EXT_extended_dynamic_state3: blend enable/equation, write mask
+		bool dynamicPolygonMode{ false };	// VK_EXT_extended_dynamic_state3: polygon mode
+		bool shaderObject{ false };			// VK_EXT_shader_object
+		bool presentWait{ false };			// VK_KHR_present_id + VK_KHR_present_wait
+		bool asyncCompute{ false };			// Compute queue from a family without graphics
+		bool swapchainMaintenance{ false };	// VK_EXT_swapchain_maintenance1: present fences tell when a retired swapchain is unused
+	};
+
+	// Latency/throughput trade-offs, fixed at startup.
+	struct RenderSettings
+	{
+		uint32_t	framesInFlight{ 3 };				// 1-4: more frames hide CPU/GPU stalls, fewer cut input latency
+		PresentMode	presentMode{ PresentMode::FIFO };
+		bool		lowLatency{ false };				// Wait for the previous present before sampling input
+
+		// Dynamic resolution: the scene renders at a fraction of the output keeping the GPU frame time under budget
+		bool		dynamicResolution{ false };
+		float		gpuBudgetMs{ 16.0f };
+		float		minRenderScale{ 0.5f };
+
+		// The scene renders straight into the swapchain image: no HDR target, no blit. Excludes dynamic resolution.
+		bool		directToSwapchain{ false };
+
+		// Picks a compute queue from a family without graphics when the device has one (GetComputeQueue)
+		bool		asyncCompute{ true };
+
+		// Logs averaged CPU/GPU frame times and barrier counts every few seconds, to compare configurations
+		bool		logFrameStats{ false };
+	};
+
 	class VulkanCore
 	{
 	public:
@@ -19,7 +53,9 @@ namespace tiny_vulkan {
 		VulkanCore(const VulkanCore&) = delete;
 		VulkanCore& operator=(const VulkanCore&) = delete;
 
-		static void Initialize(std::shared_ptr<Window> window);
+		static void Initialize(std::shared_ptr<Window> window, const RenderSettings& settings = {});
+		// No window, surface nor swapchain: frames render offscreen at the given extent (CI, benchmarks)
+		static void InitializeHeadless(VkExtent2D extent, const RenderSettings& settings = {});
 		static void AdvanceFrame();
 
 		[[nodiscard]] static VulkanCore*								 GetRaw() { return s_CoreInstance; }
@@ -27,26 +63,41 @@ namespace tiny_vulkan {
 		[[nodiscard]] static VkPhysicalDevice							 GetPhysicalDevice() { return s_PhysicalDevice; }
 		[[nodiscard]] static VkDevice									 GetDevice() { return s_Device; }
 		[[nodiscard]] static VkSurfaceKHR								 GetSurface() { return s_Surface; }
-		[[nodiscard]] static std::shared_ptr<VulkanSwapchain>			 GetSwapchain() { return s_Swapchain; }
-		[[nodiscard]] static std::shared_ptr<VulkanImage>				 GetRenderTarget() { return s_RenderTarget; }
-		[[nodiscard]] static std::shared_ptr<VulkanImage>				 GetDepthImage() { return s_DepthImage; }
+		[[nodiscard]] static const std::shared_ptr<VulkanSwapchain>&	 GetSwapchain() { return s_Swapchain; }
 		[[nodiscard]] static VkQueue									 GetGraphicsQueue() { return s_GraphicsQueue; }
 		[[nodiscard]] static VkQueue									 GetPresentQueue() { return s_PresentQueue; }
 		[[nodiscard]] static uint32_t									 GetGraphicsFamily() { return s_GraphicsFamilyIndex; }
+		[[nodiscard]] static VkQueue									 GetComputeQueue() { return s_ComputeQueue; }	// The graphics queue without async compute
+		[[nodiscard]] static uint32_t									 GetComputeFamily() { return s_ComputeFamilyIndex; }
 		[[nodiscard]] static VmaAllocator								 GetVmaAllocator() { return s_Allocator; }
 		[[nodiscard]] static std::vector<std::shared_ptr<VulkanFrame>>&  GetFrames() { return s_Frames; }
 		[[nodiscard]] static std::shared_ptr<VulkanFrame>&				 GetCurrentFrame() { return s_Frames[s_CurrentFrameIndex]; }
+		[[nodiscard]] static uint32_t									 GetCurrentFrameIndex() { return s_CurrentFrameIndex; }
+		[[nodiscard]] static const DeviceCapabilities&					 GetCapabilities() { return s_Capabilities; }
+		[[nodiscard]] static const RenderSettings&						 GetSettings() { return s_Settings; }
+		[[nodiscard]] static uint32_t									 GetFlightFrameCount() { return s_FlightFrameCount; }
+		[[nodiscard]] static uint64_t									 GetFrameNumber() { return s_FrameNumber; } // Frame being recorded, starts at 1
+		[[nodiscard]] static VkSemaphore								 GetFrameTimeline() { return s_FrameTimeline; }
+		[[nodiscard]] static bool										 IsHeadless() { return s_Window == nullptr; }
+
+		// Extent frames are produced at: the swapchain's, or the fixed headless one
+		[[nodiscard]] static VkExtent2D GetOutputExtent();
+
+		// Frame N signals the timeline with value N once all its work, and every earlier submission on the queue, completed.
+		[[nodiscard]] static uint64_t GetCompletedFrame();
+		static void WaitForFrame(uint64_t frameNumber);
 
 	private:
+		static void ApplySettings(const RenderSettings& settings);
 		static void CreateInstance();
 		static void CreateSurface(GLFWwindow* window);
 		static void SelectPhysicalDevice();
+		static void EnableOptionalFeatures();
 		static void CreateLogicalDevice();
 		static void CreateAllocator();
 		static void CreateSwapchain();
-		static void CreateRenderTarget();
-		static void CreateDepthImage();
 		static void CreateFrames();
+		static void CreateFrameTimeline();
 
 	private:
 		static VulkanCore*									s_CoreInstance;
@@ -60,15 +111,21 @@ namespace tiny_vulkan {
 		static VkDevice										s_Device;
 		static VmaAllocator									s_Allocator;
 		static std::shared_ptr<VulkanSwapchain>				s_Swapchain;
-		static std::shared_ptr<VulkanImage>					s_RenderTarget;
-		static std::shared_ptr<VulkanImage>					s_DepthImage;
 		static uint32_t										s_GraphicsFamilyIndex;
 		static uint32_t										s_PresentFamilyIndex;
 		static VkQueue										s_GraphicsQueue;
 		static VkQueue										s_PresentQueue;
+		static uint32_t										s_ComputeFamilyIndex;
+		static VkQueue										s_ComputeQueue;
 		static std::vector<std::shared_ptr<VulkanFrame>>	s_Frames;
 		static uint32_t										s_FlightFrameCount;
 		static uint32_t										s_CurrentFrameIndex;
+		static uint64_t										s_FrameNumber;
+		static VkSemaphore									s_FrameTimeline;
+		static DeviceCapabilities							s_Capabilities;
+		static RenderSettings								s_Settings;
+		static VkExtent2D									s_HeadlessExtent;
+		static bool											s_SurfaceMaintenance;	// Instance side of swapchainMaintenance
 	};
 
 }
\ No newline at end of file
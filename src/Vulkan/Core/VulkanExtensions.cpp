@@ -0,0 +1,50 @@
+#include "VulkanExtensions.h"
+
+namespace tiny_vulkan::Extensions {
+
+	// VK_EXT_extended_dynamic_state3
+	PFN_vkCmdSetPolygonModeEXT			CmdSetPolygonModeEXT = nullptr;
+	PFN_vkCmdSetColorBlendEnableEXT		CmdSetColorBlendEnableEXT = nullptr;
+	PFN_vkCmdSetColorBlendEquationEXT	CmdSetColorBlendEquationEXT = nullptr;
+	PFN_vkCmdSetColorWriteMaskEXT		CmdSetColorWriteMaskEXT = nullptr;
+
+	// VK_EXT_shader_object
+	PFN_vkCreateShadersEXT					CreateShadersEXT = nullptr;
+	PFN_vkDestroyShaderEXT					DestroyShaderEXT = nullptr;
+	PFN_vkCmdBindShadersEXT					CmdBindShadersEXT = nullptr;
+	PFN_vkCmdSetVertexInputEXT				CmdSetVertexInputEXT = nullptr;
+	PFN_vkCmdSetRasterizationSamplesEXT		CmdSetRasterizationSamplesEXT = nullptr;
+	PFN_vkCmdSetSampleMaskEXT				CmdSetSampleMaskEXT = nullptr;
+	PFN_vkCmdSetAlphaToCoverageEnableEXT	CmdSetAlphaToCoverageEnableEXT = nullptr;
+
+	// VK_KHR_present_wait
+	PFN_vkWaitForPresentKHR					WaitForPresentKHR = nullptr;
+
+	template<typename PFN>
+	static void LoadFunction(VkDevice device, PFN& function, const char* name)
+	{
+		function = reinterpret_cast<PFN>(vkGetDeviceProcAddr(device, name));
+	}
+
+	void Load(VkDevice device)
+	{
+		// VK_EXT_extended_dynamic_state3
+		LoadFunction(device, CmdSetPolygonModeEXT, "vkCmdSetPolygonModeEXT");
+		LoadFunction(device, CmdSetColorBlendEnableEXT, "vkCmdSetColorBlendEnableEXT");
+		LoadFunction(device, CmdSetColorBlendEquationEXT, "vkCmdSetColorBlendEquationEXT");
+		LoadFunction(device, CmdSetColorWriteMaskEXT, "vkCmdSetColorWriteMaskEXT");
+
+		// VK_EXT_shader_object
+		LoadFunction(device, CreateShadersEXT, "vkCreateShadersEXT");
+		LoadFunction(device, DestroyShaderEXT, "vkDestroyShaderEXT");
+		LoadFunction(device, CmdBindShadersEXT, "vkCmdBindShadersEXT");
+		LoadFunction(device, CmdSetVertexInputEXT, "vkCmdSetVertexInputEXT");
+		LoadFunction(device, CmdSetRasterizationSamplesEXT, "vkCmdSetRasterizationSamplesEXT");
+		LoadFunction(device, CmdSetSampleMaskEXT, "vkCmdSetSampleMaskEXT");
+		LoadFunction(device, CmdSetAlphaToCoverageEnableEXT, "vkCmdSetAlphaToCoverageEnableEXT");
+
+		// VK_KHR_present_wait
+		LoadFunction(device, WaitForPresentKHR, "vkWaitForPresentKHR");
+	}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace tiny_vulkan::Extensions {
+
+	/**
+	 * @brief Resolves device-level entry points of optional extensions.
+	 * The loader only exports core commands, extension commands must come from vkGetDeviceProcAddr.
+	 * Pointers stay null when the corresponding extension was not enabled.
+	 */
+	void Load(VkDevice device);
+
+	// VK_EXT_extended_dynamic_state3
+	extern PFN_vkCmdSetPolygonModeEXT			CmdSetPolygonModeEXT;
+	extern PFN_vkCmdSetColorBlendEnableEXT		CmdSetColorBlendEnableEXT;
+	extern PFN_vkCmdSetColorBlendEquationEXT	CmdSetColorBlendEquationEXT;
+	extern PFN_vkCmdSetColorWriteMaskEXT		CmdSetColorWriteMaskEXT;
+
+	// VK_EXT_shader_object (also exposes the dynamic state commands above)
+	extern PFN_vkCreateShadersEXT					CreateShadersEXT;
+	extern PFN_vkDestroyShaderEXT					DestroyShaderEXT;
+	extern PFN_vkCmdBindShadersEXT					CmdBindShadersEXT;
+	extern PFN_vkCmdSetVertexInputEXT				CmdSetVertexInputEXT;
+	extern PFN_vkCmdSetRasterizationSamplesEXT		CmdSetRasterizationSamplesEXT;
+	extern PFN_vkCmdSetSampleMaskEXT				CmdSetSampleMaskEXT;
+	extern PFN_vkCmdSetAlphaToCoverageEnableEXT		CmdSetAlphaToCoverageEnableEXT;
+
+	// VK_KHR_present_wait
+	extern PFN_vkWaitForPresentKHR					WaitForPresentKHR;
+
+}
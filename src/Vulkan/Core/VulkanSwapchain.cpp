@@ -1,16 +1,63 @@
 #include "VulkanSwapchain.h"
 #include "VulkanCore.h"
 #include "LifetimeManager.h"
+#include "DeletionQueue.h"
+#include "LogSystem.h"
 #include "VkBootstrap.h"
 
 namespace tiny_vulkan {
 
-	VulkanSwapchain::VulkanSwapchain(uint32_t width, uint32_t height)
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		std::vector<VkPresentModeKHR> GetFallbackChain(PresentMode mode)
+		{
+			switch (mode)
+			{
+			case PresentMode::FIFO_RELAXED:	return { VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR };
+			case PresentMode::MAILBOX:		return { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR };
+			case PresentMode::IMMEDIATE:	return { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR };
+			default:						return { VK_PRESENT_MODE_FIFO_KHR };
+			}
+		}
+	}
+
+	VulkanSwapchain::VulkanSwapchain(uint32_t width, uint32_t height, PresentMode presentMode)
+		: m_RequestedMode(presentMode)
 	{
 		CreateSwapchain(width, height);
 	}
 
-	void VulkanSwapchain::CreateSwapchain(uint32_t width, uint32_t height)
+	VkPresentModeKHR VulkanSwapchain::SelectPresentMode() const
+	{
+		auto physicalDevice = VulkanCore::GetPhysicalDevice();
+		auto surface = VulkanCore::GetSurface();
+
+		uint32_t count = 0;
+		CHECK_VK_RES(vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &count, nullptr));
+		std::vector<VkPresentModeKHR> supported(count);
+		CHECK_VK_RES(vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &count, supported.data()));
+
+		const auto chain = GetFallbackChain(m_RequestedMode);
+		for (const auto mode : chain)
+		{
+			if (std::ranges::find(supported, mode) != supported.end())
+			{
+				if (mode != chain.front())
+				{
+					LOG_WARN(fmt::runtime("Present mode {0} unsupported, falling back to {1}"),
+						string_VkPresentModeKHR(chain.front()),
+						string_VkPresentModeKHR(mode)
+					);
+				}
+				return mode;
+			}
+		}
+
+		// FIFO support is required by the spec
+		return VK_PRESENT_MODE_FIFO_KHR;
+	}
+
+	void VulkanSwapchain::CreateSwapchain(uint32_t width, uint32_t height, VkSwapchainKHR oldSwapchain)
 	{
 		auto device = VulkanCore::GetDevice();
 		auto physicalDevice = VulkanCore::GetPhysicalDevice();
@@ -21,7 +68,7 @@ namespace tiny_vulkan {
 		// ========================================================
 		const VkFormat desiredFormat = VK_FORMAT_R8G8B8A8_UNORM;
 		const VkColorSpaceKHR desiredColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
-		const VkPresentModeKHR desiredPresentMode = VK_PRESENT_MODE_FIFO_KHR; // V-Sync enabled by default
+		m_PresentMode = SelectPresentMode();
 
 		// ========================================================
 		// Builder
@@ -30,9 +77,10 @@ namespace tiny_vulkan {
 
 		auto vkbSwapchainResult = swapchainBuilder
 			.set_desired_format(VkSurfaceFormatKHR{ .format = desiredFormat, .colorSpace = desiredColorSpace })
-			.set_desired_present_mode(desiredPresentMode)
+			.set_desired_present_mode(m_PresentMode)
 			.set_desired_extent(width, height)
 			.add_image_usage_flags(VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+			.set_old_swapchain(oldSwapchain)
 			.build();
 
 		vkb::Swapchain vkbSwapchain = vkbSwapchainResult.value();
@@ -60,43 +108,141 @@ namespace tiny_vulkan {
 			));
 		}
 
+		// ========================================================
+		// Render semaphores (Per Image)
+		// ========================================================
+		VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+		m_RenderSemaphores.resize(images.size());
+		for (auto& semaphore : m_RenderSemaphores)
+		{
+			CHECK_VK_RES(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore));
+		}
+
 		// Register cleanup
+		for (auto semaphore : m_RenderSemaphores)
+		{
+			m_OwnDeleters->Push([=]() -> void
+				{
+					vkDestroySemaphore(device, semaphore, nullptr);
+				}
+			);
+		}
 		for (auto view : views)
 		{
-			m_OwnDeleters.push_back([=]() -> void
+			m_OwnDeleters->Push([=]() -> void
 				{
 					vkDestroyImageView(device, view, nullptr);
 				}
 			);
 		}
-		m_OwnDeleters.push_back([=]() -> void
+		m_OwnDeleters->Push([device, swapchain = m_Swapchain]() -> void
 			{
-				vkDestroySwapchainKHR(device, m_Swapchain, nullptr);
+				vkDestroySwapchainKHR(device, swapchain, nullptr);
 			}
 		);
 	}
 
 	void VulkanSwapchain::RecreateSwapchain(uint32_t width, uint32_t height)
 	{
+		// Presents queued on the old swapchain still complete after the handoff,
+		// its resources are released once they did instead of draining the GPU
+		const VkSwapchainKHR oldSwapchain = m_Swapchain;
+		std::shared_ptr<DestructorList> retired = std::move(m_OwnDeleters);
+		m_OwnDeleters = std::make_unique<DestructorList>(1024);
+		m_Images.clear();
+		m_RenderSemaphores.clear();
+
+		CreateSwapchain(width, height, oldSwapchain);
+
+		if (VulkanCore::GetCapabilities().swapchainMaintenance)
+		{
+			m_Retired.push_back(RetiredSwapchain{ .deleters = std::move(retired), .presentFences = std::exchange(m_PresentFences, {}) });
+			return;
+		}
+
+		// No present fences: the frame timeline only covers the queue, not the presentation engine
+		// still waiting on the render semaphores. Give the last presents another framesInFlight frames.
+		DeletionQueue::PushFunctionAt(VulkanCore::GetFrameNumber() + VulkanCore::GetFlightFrameCount(), [retired]()
+			{
+				retired->ExecuteAll();
+			});
+	}
+
+	VkFence VulkanSwapchain::AcquirePresentFence()
+	{
+		if (!VulkanCore::GetCapabilities().swapchainMaintenance)
+		{
+			return VK_NULL_HANDLE;
+		}
+
 		auto device = VulkanCore::GetDevice();
-		CHECK_VK_RES(vkDeviceWaitIdle(VulkanCore::GetDevice()));
 
-		CleanupResources();
+		// Presents complete in order: only the oldest can have signaled first
+		VkFence fence = VK_NULL_HANDLE;
+		if (!m_PresentFences.empty() && vkGetFenceStatus(device, m_PresentFences.front()) == VK_SUCCESS)
+		{
+			fence = m_PresentFences.front();
+			m_PresentFences.erase(m_PresentFences.begin());
+			CHECK_VK_RES(vkResetFences(device, 1, &fence));
+		}
+		else
+		{
+			VkFenceCreateInfo fenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+			CHECK_VK_RES(vkCreateFence(device, &fenceInfo, nullptr, &fence));
+		}
 
-		CreateSwapchain(width, height);
+		m_PresentFences.push_back(fence);
+		return fence;
+	}
+
+	void VulkanSwapchain::ReleaseRetired()
+	{
+		auto device = VulkanCore::GetDevice();
+
+		std::erase_if(m_Retired, [device](const RetiredSwapchain& retired)
+			{
+				const bool presented = std::ranges::all_of(retired.presentFences, [device](VkFence fence)
+					{
+						return vkGetFenceStatus(device, fence) == VK_SUCCESS;
+					});
+				if (!presented)
+				{
+					return false;
+				}
+
+				for (auto fence : retired.presentFences)
+				{
+					vkDestroyFence(device, fence, nullptr);
+				}
+				retired.deleters->ExecuteAll();
+				return true;
+			});
 	}
 
 	void VulkanSwapchain::CleanupResources()
 	{
-		for (auto it = m_OwnDeleters.rbegin(); it != m_OwnDeleters.rend(); ++it) 
+		auto device = VulkanCore::GetDevice();
+
+		// The device is idle, the presentation engine may not be
+		for (auto& retired : m_Retired)
 		{
-			if (*it)
-			{
-				(*it)();
-			}
+			m_PresentFences.insert(m_PresentFences.end(), retired.presentFences.begin(), retired.presentFences.end());
+			retired.presentFences.clear();
+		}
+		if (!m_PresentFences.empty())
+		{
+			CHECK_VK_RES(vkWaitForFences(device, (uint32_t)m_PresentFences.size(), m_PresentFences.data(), VK_TRUE, UINT64_MAX));
+		}
+		for (auto fence : m_PresentFences)
+		{
+			vkDestroyFence(device, fence, nullptr);
 		}
-		m_OwnDeleters.clear();
+		m_PresentFences.clear();
+		ReleaseRetired();
+
+		m_OwnDeleters->ExecuteAll();
 		m_Images.clear();
+		m_RenderSemaphores.clear();
 		m_Swapchain = VK_NULL_HANDLE;
 	}
 
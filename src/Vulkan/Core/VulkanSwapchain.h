@@ -1,39 +1,81 @@
 #pragma once
 
 #include "VulkanImage.h"
+#include "DestructorList.h"
 
 #include <vector>
 #include <memory>
-#include <functional>
 #include <vulkan/vulkan.h>
 
 namespace tiny_vulkan {
 
+	// Requested presentation mode. Unsupported modes fall back to the closest supported one, FIFO always exists.
+	enum class PresentMode
+	{
+		FIFO,			// V-Sync, throughput: frames queue up behind the vertical blank
+		FIFO_RELAXED,	// V-Sync, but a late frame is presented immediately (may tear) -> FIFO
+		MAILBOX,		// No tearing, the newest frame replaces the queued one -> IMMEDIATE -> FIFO
+		IMMEDIATE		// No wait, lowest latency, tears -> MAILBOX -> FIFO
+	};
+
 	class VulkanSwapchain
 	{
 	public:
-		explicit VulkanSwapchain(uint32_t width, uint32_t height);
+		explicit VulkanSwapchain(uint32_t width, uint32_t height, PresentMode presentMode = PresentMode::FIFO);
 		~VulkanSwapchain() = default;
 
 		VulkanSwapchain(const VulkanSwapchain&) = delete;
 		VulkanSwapchain& operator=(const VulkanSwapchain&) = delete;
 
-		void CreateSwapchain(uint32_t width, uint32_t height);
+		void CreateSwapchain(uint32_t width, uint32_t height, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
+
+		/**
+		 * @brief Builds a new swapchain from the current one (oldSwapchain handoff), without waiting for the device.
+		 * The old swapchain, its views and semaphores are destroyed once its last present is done with them:
+		 * tracked by present fences with VK_EXT_swapchain_maintenance1 (see ReleaseRetired), otherwise through
+		 * the DeletionQueue framesInFlight frames after the frame being recorded, as presents may lag the queue.
+		 * Call at a frame boundary, before acquiring.
+		 */
 		void RecreateSwapchain(uint32_t width, uint32_t height);
 		void CleanupResources();
 
+		// Fence to chain to the next present (VkSwapchainPresentFenceInfoEXT), VK_NULL_HANDLE without swapchainMaintenance.
+		[[nodiscard]] VkFence AcquirePresentFence();
+
+		// Destroys the retired swapchains whose present fences all signaled. Once per frame.
+		void ReleaseRetired();
+
 		[[nodiscard]] VkSwapchainKHR	GetRaw()	const { return m_Swapchain; }
 		[[nodiscard]] VkFormat			GetFormat() const { return m_Format; }
 		[[nodiscard]] VkExtent2D		GetExtent() const { return m_Extent; }
+		[[nodiscard]] VkPresentModeKHR	GetPresentMode() const { return m_PresentMode; }
 		[[nodiscard]] const std::vector<std::shared_ptr<VulkanImage>>& GetImages() const { return m_Images; }
 
+		// Signaled when rendering to the image is done, presentation waits on it.
+		// Per image: it can be reused only once the image was acquired again.
+		[[nodiscard]] VkSemaphore GetRenderSemaphore(uint32_t imageIndex) const { return m_RenderSemaphores[imageIndex]; }
+
+	private:
+		struct RetiredSwapchain
+		{
+			std::shared_ptr<DestructorList>	deleters;
+			std::vector<VkFence>			presentFences;	// Every present still pending when it was retired
+		};
+
+		[[nodiscard]] VkPresentModeKHR SelectPresentMode() const;
+
 	private:
 		VkSwapchainKHR		m_Swapchain{ VK_NULL_HANDLE };
 		VkFormat			m_Format{ VK_FORMAT_UNDEFINED };
 		VkExtent2D			m_Extent{ 0, 0 };
+		PresentMode			m_RequestedMode{ PresentMode::FIFO };
+		VkPresentModeKHR	m_PresentMode{ VK_PRESENT_MODE_FIFO_KHR };
 		std::vector<std::shared_ptr<VulkanImage>> m_Images;
+		std::vector<VkSemaphore>	m_RenderSemaphores;
+		std::vector<VkFence>		m_PresentFences;	// Oldest present first, signaled ones are recycled
+		std::vector<RetiredSwapchain> m_Retired;
 
-		std::vector<std::function<void()>> m_OwnDeleters;
+		std::unique_ptr<DestructorList> m_OwnDeleters{ std::make_unique<DestructorList>(1024) };
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "DynamicState.h"
+#include "VulkanExtensions.h"
+
+namespace tiny_vulkan::DynamicState {
+
+	VkPipelineColorBlendAttachmentState GetBlendAttachmentState(BlendMode mode)
+	{
+		VkPipelineColorBlendAttachmentState blendAttachmentState{};
+		blendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+		switch (mode)
+		{
+		case BlendMode::ALPHA:
+			blendAttachmentState.blendEnable = VK_TRUE;
+			// formula: color = srcColor * srcAlpha + dstColor * (1 - srcAlpha)
+			blendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+			blendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			blendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+			blendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			blendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			blendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+			break;
+
+		case BlendMode::ADDITIVE:
+			blendAttachmentState.blendEnable = VK_TRUE;
+			// formula: color = srcColor * srcAlpha + dstColor * 1
+			blendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+			blendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			blendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+			blendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			blendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			blendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+			break;
+
+		case BlendMode::NONE: 
+		default:
+			blendAttachmentState.blendEnable = VK_FALSE;
+			break;
+		}
+
+		return blendAttachmentState;
+	}
+
+	std::vector<VkDynamicState> GetDynamicStates(const DynamicStateSet& dynamicState)
+	{
+		std::vector<VkDynamicState> states;
+
+		if (dynamicState.extended)
+		{
+			states.push_back(VK_DYNAMIC_STATE_CULL_MODE);
+			states.push_back(VK_DYNAMIC_STATE_FRONT_FACE);
+			states.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY);
+			states.push_back(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE);
+			states.push_back(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE);
+			states.push_back(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP);
+		}
+
+		if (dynamicState.blend)
+		{
+			states.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+			states.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT);
+			states.push_back(VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT);
+		}
+
+		if (dynamicState.polygonMode)
+		{
+			states.push_back(VK_DYNAMIC_STATE_POLYGON_MODE_EXT);
+		}
+
+		return states;
+	}
+
+	VkPrimitiveTopology GetTopologyClass(VkPrimitiveTopology topology)
+	{
+		switch (topology)
+		{
+		case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+			return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+			return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+
+		case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+			return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+
+		default:
+			return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		}
+	}
+
+	void CmdSetRasterState(
+		VkCommandBuffer			cmdBuffer,
+		const RasterState&		state,
+		const DynamicStateSet&	dynamicState,
+		uint32_t				colorAttachmentCount)
+	{
+		if (dynamicState.extended)
+		{
+			vkCmdSetCullMode(cmdBuffer, state.cullMode);
+			vkCmdSetFrontFace(cmdBuffer, state.frontFace);
+			vkCmdSetPrimitiveTopology(cmdBuffer, state.topology);
+			vkCmdSetDepthTestEnable(cmdBuffer, state.depthTestEnable ? VK_TRUE : VK_FALSE);
+			vkCmdSetDepthWriteEnable(cmdBuffer, state.depthWriteEnable ? VK_TRUE : VK_FALSE);
+			vkCmdSetDepthCompareOp(cmdBuffer, state.depthCompareOp);
+		}
+
+		if (dynamicState.polygonMode)
+		{
+			Extensions::CmdSetPolygonModeEXT(cmdBuffer, state.polygonMode);
+		}
+
+		if (dynamicState.blend && colorAttachmentCount > 0)
+		{
+			const auto attachment = GetBlendAttachmentState(state.blendMode);
+
+			VkColorBlendEquationEXT equation{};
+			equation.srcColorBlendFactor = attachment.srcColorBlendFactor;
+			equation.dstColorBlendFactor = attachment.dstColorBlendFactor;
+			equation.colorBlendOp = attachment.colorBlendOp;
+			equation.srcAlphaBlendFactor = attachment.srcAlphaBlendFactor;
+			equation.dstAlphaBlendFactor = attachment.dstAlphaBlendFactor;
+			equation.alphaBlendOp = attachment.alphaBlendOp;
+
+			std::vector<VkBool32>					enables(colorAttachmentCount, attachment.blendEnable);
+			std::vector<VkColorBlendEquationEXT>	equations(colorAttachmentCount, equation);
+			std::vector<VkColorComponentFlags>		writeMasks(colorAttachmentCount, attachment.colorWriteMask);
+
+			Extensions::CmdSetColorBlendEnableEXT(cmdBuffer, 0, colorAttachmentCount, enables.data());
+			Extensions::CmdSetColorBlendEquationEXT(cmdBuffer, 0, colorAttachmentCount, equations.data());
+			Extensions::CmdSetColorWriteMaskEXT(cmdBuffer, 0, colorAttachmentCount, writeMasks.data());
+		}
+	}
+
+	void CmdSetShaderObjectState(
+		VkCommandBuffer			cmdBuffer,
+		const RasterState&		state,
+		uint32_t				colorAttachmentCount)
+	{
+		// Vertices are pulled from buffers in the shaders, no vertex input bindings
+		Extensions::CmdSetVertexInputEXT(cmdBuffer, 0, nullptr, 0, nullptr);
+
+		vkCmdSetRasterizerDiscardEnable(cmdBuffer, VK_FALSE);
+		vkCmdSetPrimitiveRestartEnable(cmdBuffer, VK_FALSE);
+		vkCmdSetDepthBiasEnable(cmdBuffer, VK_FALSE);
+		vkCmdSetDepthBoundsTestEnable(cmdBuffer, VK_FALSE);
+		vkCmdSetStencilTestEnable(cmdBuffer, VK_FALSE);
+		vkCmdSetLineWidth(cmdBuffer, 1.0f);
+
+		const VkSampleMask sampleMask = ~0u;
+		Extensions::CmdSetRasterizationSamplesEXT(cmdBuffer, VK_SAMPLE_COUNT_1_BIT);
+		Extensions::CmdSetSampleMaskEXT(cmdBuffer, VK_SAMPLE_COUNT_1_BIT, &sampleMask);
+		Extensions::CmdSetAlphaToCoverageEnableEXT(cmdBuffer, VK_FALSE);
+
+		const DynamicStateSet allDynamic{ .extended = true, .blend = true, .polygonMode = true };
+		CmdSetRasterState(cmdBuffer, state, allDynamic, colorAttachmentCount);
+	}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "VulkanPipeline.h"
+
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace tiny_vulkan::DynamicState {
+
+	// Blend factors/ops for a BlendMode, shared by baked and dynamic blending.
+	[[nodiscard]] VkPipelineColorBlendAttachmentState GetBlendAttachmentState(BlendMode mode);
+
+	// Dynamic states (besides viewport/scissor) a pipeline declares for the given groups.
+	[[nodiscard]] std::vector<VkDynamicState> GetDynamicStates(const DynamicStateSet& dynamicState);
+
+	/**
+	 * @brief Dynamic topology may only switch within a topology class,
+	 * so the pipeline key keeps the class instead of the exact topology.
+	 */
+	[[nodiscard]] VkPrimitiveTopology GetTopologyClass(VkPrimitiveTopology topology);
+
+	/**
+	 * @brief Records the dynamic groups of state for the next draws.
+	 * Lets materials that share a pipeline differ in culling, depth and blending.
+	 */
+	void CmdSetRasterState(
+		VkCommandBuffer			cmdBuffer,
+		const RasterState&		state,
+		const DynamicStateSet&	dynamicState,
+		uint32_t				colorAttachmentCount
+	);
+
+	/**
+	 * @brief Shader objects carry no state at all, so everything a draw consumes is recorded here,
+	 * followed by the raster state with every group dynamic.
+	 */
+	void CmdSetShaderObjectState(
+		VkCommandBuffer			cmdBuffer,
+		const RasterState&		state,
+		uint32_t				colorAttachmentCount
+	);
+
+}
@@ -0,0 +1,165 @@
+#include "PipelineBenchmark.h"
+#include "PipelineRegistry.h"
+#include "PipelineLibrary.h"
+#include "CommandsExecutor.h"
+#include "VulkanCore.h"
+#include "LogSystem.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+namespace tiny_vulkan::PipelineBenchmark {
+
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+
+		// The renderer's pipelines use D32: these never collide with a registered description
+		constexpr VkFormat BENCH_DEPTH_FORMAT = VK_FORMAT_D16_UNORM;
+		constexpr std::array<VkFormat, 2> BENCH_COLOR_FORMATS = { VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT };
+		constexpr uint32_t BIND_RUNS = 16;
+
+		// One measured way of building the material
+		struct Config
+		{
+			const char*		name;
+			PipelineBackend	backend;
+			bool			pipelineLibrary;	// Parts are cached across builds: after the first one, only the link is paid
+		};
+
+		struct ConfigResult
+		{
+			std::vector<double>	creationUs;
+			double				bindCpuNs{ 0.0 };
+		};
+
+		double Median(std::vector<double> values)
+		{
+			if (values.empty())
+			{
+				return 0.0;
+			}
+			std::ranges::sort(values);
+			return values[values.size() / 2];
+		}
+
+		// No background optimization: a pending link would outlive the retired pipeline and skew later builds
+		VulkanPipelineBuilder MakeVariant(const VulkanPipelineBuilder& builder, const Config& config, VkFormat colorFormat)
+		{
+			VulkanPipelineBuilder variant = builder;
+			return variant
+				.SetBackend(config.backend)
+				.UsePipelineLibrary(config.pipelineLibrary)
+				.EnableBackgroundOptimization(false)
+				.SetColorAttachmentFormats({ colorFormat })
+				.SetDepthFormat(BENCH_DEPTH_FORMAT);
+		}
+
+		// Drops the variant from the registry and retires its handles, so the next Build creates it again
+		void Retire(const VulkanPipelineBuilder& variant, const std::shared_ptr<VulkanPipeline>& pipeline)
+		{
+			(void)PipelineRegistry::Unregister(variant.MakeDesc());
+			pipeline->Retarget(nullptr);
+		}
+
+		bool MeasureCreation(const VulkanPipelineBuilder& builder, const Config& config, uint32_t buildCount, ConfigResult& result)
+		{
+			for (uint32_t i = 0; i < buildCount; ++i)
+			{
+				VulkanPipelineBuilder variant = MakeVariant(builder, config, BENCH_COLOR_FORMATS[0]);
+
+				const auto start = std::chrono::steady_clock::now();
+				auto pipeline = variant.Build();
+				const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+				if (!pipeline)
+				{
+					LOG_ERROR(fmt::runtime("Pipeline benchmark: {0} build failed"), config.name);
+					return false;
+				}
+				result.creationUs.push_back(elapsed.count());
+				Retire(variant, pipeline);
+			}
+			return true;
+		}
+
+		// CPU recording cost only: drivers defer bound state to the next draw, timing binds alone on the GPU shows nothing
+		bool MeasureBinds(const VulkanPipelineBuilder& builder, const Config& config, uint32_t bindCount, ConfigResult& result)
+		{
+			// Two pipelines alternating, so no bind is redundant
+			std::array<VulkanPipelineBuilder, 2> variants = {
+				MakeVariant(builder, config, BENCH_COLOR_FORMATS[0]),
+				MakeVariant(builder, config, BENCH_COLOR_FORMATS[1])
+			};
+			std::array<std::shared_ptr<VulkanPipeline>, 2> pipelines = { variants[0].Build(), variants[1].Build() };
+			if (!pipelines[0] || !pipelines[1])
+			{
+				LOG_ERROR(fmt::runtime("Pipeline benchmark: {0} build failed"), config.name);
+				return false;
+			}
+
+			std::vector<double> cpuNs;
+			for (uint32_t run = 0; run < BIND_RUNS; ++run)
+			{
+				CommandExecutor::Execute([&](VkCommandBuffer cmd)
+					{
+						const auto start = std::chrono::steady_clock::now();
+						for (uint32_t i = 0; i < bindCount; ++i)
+						{
+							pipelines[i & 1]->CmdBind(cmd);
+						}
+						const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+						cpuNs.push_back(elapsed.count() / bindCount);
+					});
+			}
+			result.bindCpuNs = Median(std::move(cpuNs));
+
+			Retire(variants[0], pipelines[0]);
+			Retire(variants[1], pipelines[1]);
+			return true;
+		}
+	}
+
+	void Run(const VulkanPipelineBuilder& builder, uint32_t buildCount, uint32_t bindCount)
+	{
+		std::vector<Config> configs = { Config{ "pipeline", PipelineBackend::PIPELINE, false } };
+		if (PipelineLibrary::IsSupported())
+		{
+			configs.push_back(Config{ "pipeline library", PipelineBackend::PIPELINE, true });
+		}
+		if (VulkanCore::GetCapabilities().shaderObject)
+		{
+			configs.push_back(Config{ "shader object", PipelineBackend::SHADER_OBJECT, false });
+		}
+		else
+		{
+			LOG_WARN("VK_EXT_shader_object is not available, only pipelines are measured");
+		}
+
+		buildCount = std::max(buildCount, 1u);
+		bindCount = std::max(bindCount, 2u);
+
+		for (const Config& config : configs)
+		{
+			ConfigResult result;
+			if (!MeasureCreation(builder, config, buildCount, result) ||
+				!MeasureBinds(builder, config, bindCount, result))
+			{
+				continue;
+			}
+
+			// The first build may also miss driver-internal shader caches the later ones hit.
+			// Library parts the scene pipeline already compiled are shared, so even the first library build may only link.
+			LOG_INFO(fmt::runtime("Pipeline benchmark ({0}): creation {1:.0f} us first, {2:.0f} us median over {3} builds; "
+				"bind {4:.1f} ns CPU recording over {5} alternating binds"),
+				config.name,
+				result.creationUs.front(),
+				Median(result.creationUs),
+				buildCount,
+				result.bindCpuNs,
+				bindCount
+			);
+		}
+	}
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "VulkanPipeline.h"
+
+#include <cstdint>
+
+// A/B measurement of the pipeline backends (VkPipeline vs VK_EXT_shader_object) on a real material.
+namespace tiny_vulkan::PipelineBenchmark {
+
+	/**
+	 * @brief Builds variants of builder as monolithic pipelines, from pipeline libraries and as shader objects
+	 * (the last two when supported) and logs for each:
+	 * - creation latency: buildCount Build() calls missing the registry (first one and median), each result retired after
+	 * - bind cost: CPU recording time per CmdBind, alternating two pipelines bindCount times
+	 * The variants use attachment formats of their own, so pipelines already registered are neither reused nor touched.
+	 * Blocks on the graphics queue: run it outside the frame loop.
+	 */
+	void Run(const VulkanPipelineBuilder& builder, uint32_t buildCount = 50, uint32_t bindCount = 10000);
+
+}
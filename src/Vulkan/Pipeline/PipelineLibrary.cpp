@@ -0,0 +1,174 @@
+#include "PipelineLibrary.h"
+#include "VulkanCore.h"
+#include "PipelineRegistry.h"
+#include "LifetimeManager.h"
+#include "LogSystem.h"
+#include "Hash.h"
+
+namespace tiny_vulkan::PipelineLibrary {
+
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		struct PendingLink
+		{
+			std::weak_ptr<VulkanPipeline>	pipeline;
+			std::future<VkPipeline>			result;
+		};
+
+		std::mutex								g_Mutex;
+		std::unordered_map<uint64_t, VkPipeline>	g_Parts;
+		std::vector<PendingLink>				g_PendingLinks;
+		bool									g_CleanupRegistered = false;
+
+		VkGraphicsPipelineLibraryFlagsEXT GetLibraryFlags(LibraryPart part)
+		{
+			switch (part)
+			{
+			case LibraryPart::VERTEX_INPUT:		 return VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+			case LibraryPart::PRE_RASTERIZATION: return VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+			case LibraryPart::FRAGMENT_SHADER:	 return VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+			case LibraryPart::FRAGMENT_OUTPUT:	 return VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+			default:
+				return 0;
+			}
+		}
+
+		// Libraries and in-flight relinks are owned here, so they are torn down together
+		// (pending links first) before the device goes away.
+		void RegisterCleanup()
+		{
+			if (g_CleanupRegistered)
+			{
+				return;
+			}
+			g_CleanupRegistered = true;
+
+			LifetimeManager::PushFunction([]()
+				{
+					auto device = VulkanCore::GetDevice();
+
+					std::lock_guard lock(g_Mutex);
+					for (auto& pending : g_PendingLinks)
+					{
+						VkPipeline pipeline = pending.result.get();
+						if (pipeline != VK_NULL_HANDLE)
+						{
+							vkDestroyPipeline(device, pipeline, nullptr);
+						}
+					}
+					g_PendingLinks.clear();
+
+					for (auto& [key, library] : g_Parts)
+					{
+						vkDestroyPipeline(device, library, nullptr);
+					}
+					g_Parts.clear();
+				});
+		}
+	}
+
+	bool IsSupported()
+	{
+		return VulkanCore::GetCapabilities().graphicsPipelineLibrary;
+	}
+
+	VkPipeline GetOrCreatePart(LibraryPart part, uint64_t key, VkGraphicsPipelineCreateInfo& partInfo)
+	{
+		uint64_t partKey = key;
+		Hash::Combine(partKey, part);
+
+		std::lock_guard lock(g_Mutex);
+
+		auto it = g_Parts.find(partKey);
+		if (it != g_Parts.end())
+		{
+			return it->second;
+		}
+
+		RegisterCleanup();
+
+		VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo = {};
+		libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+		libraryInfo.pNext = partInfo.pNext;
+		libraryInfo.flags = GetLibraryFlags(part);
+
+		partInfo.pNext = &libraryInfo;
+		partInfo.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+		VkPipeline library{ VK_NULL_HANDLE };
+		CHECK_VK_RES(vkCreateGraphicsPipelines(VulkanCore::GetDevice(), VK_NULL_HANDLE, 1, &partInfo, nullptr, &library));
+
+		g_Parts.emplace(partKey, library);
+		return library;
+	}
+
+	VkPipeline Link(const LibrarySet& libraries, VkPipelineLayout layout, bool optimize)
+	{
+		VkPipelineLibraryCreateInfoKHR linkInfo = {};
+		linkInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		linkInfo.libraryCount = (uint32_t)libraries.size();
+		linkInfo.pLibraries = libraries.data();
+
+		VkGraphicsPipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.pNext = &linkInfo;
+		pipelineInfo.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+		pipelineInfo.layout = layout;
+
+		VkPipeline pipeline{ VK_NULL_HANDLE };
+		CHECK_VK_RES(vkCreateGraphicsPipelines(VulkanCore::GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline));
+
+		return pipeline;
+	}
+
+	void RequestOptimizedLink(std::shared_ptr<VulkanPipeline> pipeline, const LibrarySet& libraries, VkPipelineLayout layout)
+	{
+		std::lock_guard lock(g_Mutex);
+
+		RegisterCleanup();
+
+		g_PendingLinks.push_back(PendingLink{
+			.pipeline = pipeline,
+			.result = std::async(std::launch::async, [libraries, layout]() { return Link(libraries, layout, true); })
+			});
+	}
+
+	void ProcessCompletedLinks()
+	{
+		std::lock_guard lock(g_Mutex);
+
+		auto device = VulkanCore::GetDevice();
+
+		for (auto it = g_PendingLinks.begin(); it != g_PendingLinks.end(); )
+		{
+			if (it->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				++it;
+				continue;
+			}
+
+			VkPipeline optimized = it->result.get();
+			// A pipeline retargeted meanwhile (hot reload) no longer binds its own handle
+			if (auto pipeline = it->pipeline.lock(); pipeline && !pipeline->IsView() && optimized != VK_NULL_HANDLE)
+			{
+				// The fast-linked handle may still be referenced by frames in flight
+				PipelineRegistry::TrackPipeline(optimized);
+				PipelineRegistry::RetirePipeline(pipeline->ReplaceRaw(optimized));
+				LOG_DEBUG("Optimized pipeline swapped in");
+			}
+			else if (optimized != VK_NULL_HANDLE)
+			{
+				vkDestroyPipeline(device, optimized, nullptr);
+			}
+
+			it = g_PendingLinks.erase(it);
+		}
+	}
+
+	size_t GetPartCount()
+	{
+		std::lock_guard lock(g_Mutex);
+		return g_Parts.size();
+	}
+
+}
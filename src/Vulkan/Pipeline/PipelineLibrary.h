@@ -0,0 +1,45 @@
+#pragma once
+
+#include "VulkanPipeline.h"
+
+#include <array>
+#include <memory>
+#include <vulkan/vulkan.h>
+
+namespace tiny_vulkan::PipelineLibrary {
+
+	// The four independently compiled state subsets of VK_EXT_graphics_pipeline_library.
+	enum class LibraryPart
+	{
+		VERTEX_INPUT,
+		PRE_RASTERIZATION,
+		FRAGMENT_SHADER,
+		FRAGMENT_OUTPUT,
+		COUNT
+	};
+
+	using LibrarySet = std::array<VkPipeline, static_cast<size_t>(LibraryPart::COUNT)>;
+
+	[[nodiscard]] bool IsSupported();
+
+	/**
+	 * @brief Returns the cached library for (part, key) or compiles it from partInfo.
+	 * partInfo must describe only the state of that part; the library flags are added here.
+	 */
+	[[nodiscard]] VkPipeline GetOrCreatePart(LibraryPart part, uint64_t key, VkGraphicsPipelineCreateInfo& partInfo);
+
+	// Links the parts into an executable pipeline. Without optimization this is the cheap fast-link path.
+	[[nodiscard]] VkPipeline Link(const LibrarySet& libraries, VkPipelineLayout layout, bool optimize);
+
+	/**
+	 * @brief Relinks the libraries with link-time optimization on a background thread.
+	 * The result replaces the fast-linked handle of pipeline in ProcessCompletedLinks.
+	 */
+	void RequestOptimizedLink(std::shared_ptr<VulkanPipeline> pipeline, const LibrarySet& libraries, VkPipelineLayout layout);
+
+	// Swaps finished optimized pipelines in. Must be called on the render thread at a frame boundary.
+	void ProcessCompletedLinks();
+
+	[[nodiscard]] size_t GetPartCount();
+
+}
@@ -0,0 +1,233 @@
+#include "PipelineRegistry.h"
+#include "VulkanCore.h"
+#include "LifetimeManager.h"
+#include "DeletionQueue.h"
+#include "VulkanExtensions.h"
+#include "DescriptorSetLayout.h"
+#include "LogSystem.h"
+
+namespace tiny_vulkan::PipelineRegistry {
+
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		std::mutex g_Mutex;
+		std::unordered_map<GraphicsPipelineDesc, std::shared_ptr<VulkanPipeline>, GraphicsPipelineDescHasher> g_Pipelines;
+		std::unordered_map<PipelineLayoutDesc, VkPipelineLayout, PipelineLayoutDescHasher> g_Layouts;
+		std::unordered_map<DescriptorSetLayoutDesc, VkDescriptorSetLayout, DescriptorSetLayoutDescHasher> g_SetLayouts;
+		std::unordered_set<VkPipeline> g_OwnedPipelines;
+		std::unordered_set<VkShaderEXT> g_OwnedShaderObjects;
+		size_t g_CacheHits = 0;
+		size_t g_CacheMisses = 0;
+		bool g_CleanupRegistered = false;
+
+		// Every handle still owned at shutdown goes in one deleter, pipelines before the layouts they use.
+		void RegisterCleanup()
+		{
+			if (g_CleanupRegistered)
+			{
+				return;
+			}
+			g_CleanupRegistered = true;
+
+			LifetimeManager::PushFunction([]()
+				{
+					auto device = VulkanCore::GetDevice();
+
+					std::lock_guard lock(g_Mutex);
+					for (VkPipeline pipeline : g_OwnedPipelines)
+					{
+						vkDestroyPipeline(device, pipeline, nullptr);
+					}
+					for (VkShaderEXT shaderObject : g_OwnedShaderObjects)
+					{
+						Extensions::DestroyShaderEXT(device, shaderObject, nullptr);
+					}
+					for (auto& [desc, layout] : g_Layouts)
+					{
+						vkDestroyPipelineLayout(device, layout, nullptr);
+					}
+					g_OwnedPipelines.clear();
+					g_OwnedShaderObjects.clear();
+					g_Layouts.clear();
+				});
+		}
+	}
+
+	std::shared_ptr<VulkanPipeline> Find(const GraphicsPipelineDesc& desc)
+	{
+		std::lock_guard lock(g_Mutex);
+
+		auto it = g_Pipelines.find(desc);
+		if (it == g_Pipelines.end())
+		{
+			++g_CacheMisses;
+			return nullptr;
+		}
+
+		++g_CacheHits;
+		LOG_DEBUG(fmt::runtime("Pipeline cache hit: {:016x}"), desc.GetHash());
+		return it->second;
+	}
+
+	void Register(const GraphicsPipelineDesc& desc, std::shared_ptr<VulkanPipeline> pipeline)
+	{
+		std::lock_guard lock(g_Mutex);
+		g_Pipelines.emplace(desc, std::move(pipeline));
+	}
+
+	std::shared_ptr<VulkanPipeline> Unregister(const GraphicsPipelineDesc& desc)
+	{
+		std::lock_guard lock(g_Mutex);
+
+		auto node = g_Pipelines.extract(desc);
+		return node.empty() ? nullptr : std::move(node.mapped());
+	}
+
+	void TrackPipeline(VkPipeline pipeline)
+	{
+		std::lock_guard lock(g_Mutex);
+		RegisterCleanup();
+		g_OwnedPipelines.insert(pipeline);
+	}
+
+	void RetirePipeline(VkPipeline pipeline)
+	{
+		{
+			std::lock_guard lock(g_Mutex);
+			if (pipeline == VK_NULL_HANDLE || g_OwnedPipelines.erase(pipeline) == 0)
+			{
+				return;
+			}
+		}
+
+		DeletionQueue::PushFunction(vkDestroyPipeline, VulkanCore::GetDevice(), pipeline, nullptr);
+	}
+
+	void TrackShaderObject(VkShaderEXT shaderObject)
+	{
+		std::lock_guard lock(g_Mutex);
+		RegisterCleanup();
+		g_OwnedShaderObjects.insert(shaderObject);
+	}
+
+	void RetireShaderObject(VkShaderEXT shaderObject)
+	{
+		{
+			std::lock_guard lock(g_Mutex);
+			if (shaderObject == VK_NULL_HANDLE || g_OwnedShaderObjects.erase(shaderObject) == 0)
+			{
+				return;
+			}
+		}
+
+		DeletionQueue::PushFunction(Extensions::DestroyShaderEXT, VulkanCore::GetDevice(), shaderObject, nullptr);
+	}
+
+	VkPipelineLayout GetOrCreateLayout(const PipelineLayoutDesc& desc)
+	{
+		std::lock_guard lock(g_Mutex);
+
+		auto it = g_Layouts.find(desc);
+		if (it != g_Layouts.end())
+		{
+			return it->second;
+		}
+
+		auto device = VulkanCore::GetDevice();
+
+		VkPipelineLayoutCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		info.pSetLayouts = desc.descriptorSetLayouts.data();
+		info.setLayoutCount = (uint32_t)desc.descriptorSetLayouts.size();
+		info.pPushConstantRanges = desc.pushConstantRanges.data();
+		info.pushConstantRangeCount = (uint32_t)desc.pushConstantRanges.size();
+
+		VkPipelineLayout layout{ VK_NULL_HANDLE };
+		CHECK_VK_RES(vkCreatePipelineLayout(device, &info, nullptr, &layout));
+
+		RegisterCleanup();
+		g_Layouts.emplace(desc, layout);
+		return layout;
+	}
+
+	void ReleaseUnusedLayouts()
+	{
+		std::lock_guard lock(g_Mutex);
+
+		std::unordered_set<VkPipelineLayout> used;
+		for (const auto& [desc, pipeline] : g_Pipelines)
+		{
+			used.insert(pipeline->GetLayout());
+		}
+
+		auto device = VulkanCore::GetDevice();
+		std::erase_if(g_Layouts, [&](const auto& entry)
+			{
+				if (used.contains(entry.second))
+				{
+					return false;
+				}
+				DeletionQueue::PushFunction(vkDestroyPipelineLayout, device, entry.second, nullptr);
+				return true;
+			});
+	}
+
+	VkDescriptorSetLayout GetOrCreateSetLayout(const DescriptorSetLayoutDesc& desc)
+	{
+		std::lock_guard lock(g_Mutex);
+
+		auto it = g_SetLayouts.find(desc);
+		if (it != g_SetLayouts.end())
+		{
+			return it->second;
+		}
+
+		DescriptorLayoutBuilder builder;
+		for (const auto& binding : desc.bindings)
+		{
+			static_cast<void>(builder.AddBinding(binding.binding, binding.descriptorCount, binding.descriptorType, binding.stageFlags));
+		}
+
+		VkDescriptorSetLayout setLayout = builder.Build(VulkanCore::GetDevice());
+
+		g_SetLayouts.emplace(desc, setLayout);
+		return setLayout;
+	}
+
+	size_t GetPipelineCount()
+	{
+		std::lock_guard lock(g_Mutex);
+		return g_Pipelines.size();
+	}
+
+	size_t GetLayoutCount()
+	{
+		std::lock_guard lock(g_Mutex);
+		return g_Layouts.size();
+	}
+
+	size_t GetCacheHits()
+	{
+		std::lock_guard lock(g_Mutex);
+		return g_CacheHits;
+	}
+
+	size_t GetCacheMisses()
+	{
+		std::lock_guard lock(g_Mutex);
+		return g_CacheMisses;
+	}
+
+	void LogStats()
+	{
+		std::lock_guard lock(g_Mutex);
+		LOG_INFO(fmt::runtime("Pipeline registry: {0} pipelines, {1} layouts, {2} set layouts, {3} hits, {4} misses"),
+			g_Pipelines.size(),
+			g_Layouts.size(),
+			g_SetLayouts.size(),
+			g_CacheHits,
+			g_CacheMisses
+		);
+	}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "VulkanPipeline.h"
+
+#include <memory>
+#include <vulkan/vulkan.h>
+
+namespace tiny_vulkan::PipelineRegistry {
+
+	/**
+	 * @brief Global cache of built pipelines keyed by their canonical description.
+	 * VulkanPipelineBuilder::Build consults it first, so identical materials share one VkPipeline.
+	 */
+	[[nodiscard]] std::shared_ptr<VulkanPipeline> Find(const GraphicsPipelineDesc& desc);
+
+	void Register(const GraphicsPipelineDesc& desc, std::shared_ptr<VulkanPipeline> pipeline);
+
+	// Removes desc from the cache (e.g. its shaders were edited) and returns the pipeline it mapped to, if any.
+	[[nodiscard]] std::shared_ptr<VulkanPipeline> Unregister(const GraphicsPipelineDesc& desc);
+
+	/**
+	 * @brief VkPipeline handles are owned here rather than by the LifetimeManager, so they can be
+	 * retired while running: RetirePipeline destroys the handle once frames in flight are done with it.
+	 * Untracked handles are ignored.
+	 */
+	void TrackPipeline(VkPipeline pipeline);
+	void RetirePipeline(VkPipeline pipeline);
+
+	// Same ownership for the VK_EXT_shader_object backend.
+	void TrackShaderObject(VkShaderEXT shaderObject);
+	void RetireShaderObject(VkShaderEXT shaderObject);
+
+	// Pipeline layouts are deduplicated the same way, by set layouts and push constant ranges.
+	[[nodiscard]] VkPipelineLayout GetOrCreateLayout(const PipelineLayoutDesc& desc);
+
+	// Retires the pipeline layouts no registered pipeline uses anymore (e.g. after a reload changed the interface).
+	void ReleaseUnusedLayouts();
+
+	// Descriptor set layouts (e.g. from shader reflection) are shared by their bindings.
+	[[nodiscard]] VkDescriptorSetLayout GetOrCreateSetLayout(const DescriptorSetLayoutDesc& desc);
+
+	// Statistics
+	[[nodiscard]] size_t GetPipelineCount();
+	[[nodiscard]] size_t GetLayoutCount();
+	[[nodiscard]] size_t GetCacheHits();
+	[[nodiscard]] size_t GetCacheMisses();
+
+	void LogStats();
+
+}
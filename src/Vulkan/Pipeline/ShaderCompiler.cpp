@@ -0,0 +1,306 @@
+#include "ShaderCompiler.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <format>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <shaderc/shaderc.hpp>
+
+// Compiler identity set by the build (SDK version and hash of the shaderc library): a shaderc/glslang
+// upgrade may generate other SPIR-V from the same source, so it is part of every cache key and manifest.
+#ifndef TINY_SHADERC_IDENTITY
+#define TINY_SHADERC_IDENTITY "shaderc unknown"
+#endif
+
+namespace tiny_vulkan::ShaderCompiler {
+
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+
+		// Compile options, shared by compilation and the cache key
+		constexpr shaderc_env_version			g_TargetEnvVersion = shaderc_env_version_vulkan_1_3;
+		constexpr shaderc_optimization_level	g_OptimizationLevel = shaderc_optimization_level_performance;
+		constexpr const char*					g_EntryPoint = "main";
+
+		constexpr uint32_t		SPIRV_MAGIC = 0x07230203;
+		constexpr const char*	MANIFEST_HEADER = "# tiny_vulkan shader manifest v4";
+		constexpr const char*	COMPILER_IDENTITY = TINY_SHADERC_IDENTITY;
+
+		// A manifest written by another compiler build is not read at all
+		std::string MakeManifestHeader()
+		{
+			return std::format("{0} ({1})", MANIFEST_HEADER, COMPILER_IDENTITY);
+		}
+
+		shaderc::CompileOptions MakeCompileOptions()
+		{
+			shaderc::CompileOptions options;
+			options.SetTargetEnvironment(shaderc_target_env_vulkan, g_TargetEnvVersion);
+			options.SetOptimizationLevel(g_OptimizationLevel);
+			return options;
+		}
+
+		// shaderc::Compiler is not thread safe, each (worker) thread keeps its own.
+		shaderc::Compiler& GetCompiler()
+		{
+			thread_local shaderc::Compiler compiler;
+			return compiler;
+		}
+
+		// Resolves #include relative to the including file and records what was included.
+		class Includer : public shaderc::CompileOptions::IncluderInterface
+		{
+		public:
+			explicit Includer(std::vector<std::filesystem::path>& dependencies)
+				: m_Dependencies(dependencies)
+			{
+			}
+
+			shaderc_include_result* GetInclude(const char* requestedSource, shaderc_include_type type, const char* requestingSource, size_t includeDepth) override
+			{
+				auto* include = new IncludeData{};
+
+				const auto resolved = CanonicalPath(std::filesystem::path(requestingSource).parent_path() / requestedSource);
+
+				std::ifstream file(resolved, std::ios::binary);
+				if (file.is_open())
+				{
+					include->name = resolved.generic_string();
+					include->content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+					if (std::ranges::find(m_Dependencies, resolved) == m_Dependencies.end())
+					{
+						m_Dependencies.push_back(resolved);
+					}
+				}
+				else
+				{
+					// An empty name signals the failure, content carries the message
+					include->content = "Cannot open include file: " + resolved.generic_string();
+				}
+
+				include->result.source_name = include->name.c_str();
+				include->result.source_name_length = include->name.size();
+				include->result.content = include->content.c_str();
+				include->result.content_length = include->content.size();
+				include->result.user_data = include;
+				return &include->result;
+			}
+
+			void ReleaseInclude(shaderc_include_result* result) override
+			{
+				delete static_cast<IncludeData*>(result->user_data);
+			}
+
+		private:
+			struct IncludeData
+			{
+				std::string				name;
+				std::string				content;
+				shaderc_include_result	result{};
+			};
+
+			std::vector<std::filesystem::path>& m_Dependencies;
+		};
+
+		shaderc_shader_kind GetShadercKind(const std::filesystem::path& path)
+		{
+			auto ext = path.extension().string();
+			if (ext == ".vert") return shaderc_vertex_shader;
+			if (ext == ".frag") return shaderc_fragment_shader;
+			if (ext == ".comp") return shaderc_compute_shader;
+			if (ext == ".geom") return shaderc_geometry_shader;
+			if (ext == ".tesc") return shaderc_tess_control_shader;
+			if (ext == ".tese") return shaderc_tess_evaluation_shader;
+			if (ext == ".mesh") return shaderc_mesh_shader;
+			if (ext == ".task") return shaderc_task_shader;
+			return shaderc_glsl_infer_from_source;
+		}
+	}
+
+	uint64_t GetVariantKey(const Defines& defines)
+	{
+		if (defines.empty())
+		{
+			return 0;
+		}
+
+		uint64_t key = Hash::FNV_OFFSET_BASIS;
+		for (const auto& [name, value] : defines)
+		{
+			Hash::CombineHash(key, Hash::String(name));
+			Hash::CombineHash(key, Hash::String(value));
+		}
+		return key;
+	}
+
+	std::filesystem::path CanonicalPath(const std::filesystem::path& path)
+	{
+		std::error_code ec;
+		auto canonical = std::filesystem::weakly_canonical(path, ec);
+		return ec ? std::filesystem::absolute(path).lexically_normal() : canonical;
+	}
+
+	bool Preprocess(
+		const std::filesystem::path&			path,
+		const std::string&						source,
+		const Defines&							defines,
+		std::string&							outSource,
+		std::vector<std::filesystem::path>&		outDependencies,
+		std::string&							outError)
+	{
+		// Defines and includes only matter here, the preprocessed source (and so the cache key) already reflects them
+		shaderc::CompileOptions options = MakeCompileOptions();
+		for (const auto& [name, value] : defines)
+		{
+			options.AddMacroDefinition(name, value);
+		}
+
+		outDependencies.clear();
+		options.SetIncluder(std::make_unique<Includer>(outDependencies));
+
+		shaderc::PreprocessedSourceCompilationResult result = GetCompiler().PreprocessGlsl(
+			source.c_str(),
+			source.size(),
+			GetShadercKind(path),
+			path.string().c_str(),
+			options
+		);
+
+		if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+		{
+			outError = result.GetErrorMessage();
+			return false;
+		}
+
+		outSource.assign(result.begin(), result.end());
+		return true;
+	}
+
+	bool Compile(const std::filesystem::path& path, const std::string& preprocessedSource, std::vector<uint32_t>& outSpirv, std::string& outError)
+	{
+		shaderc::SpvCompilationResult result = GetCompiler().CompileGlslToSpv(
+			preprocessedSource.c_str(),
+			preprocessedSource.size(),
+			GetShadercKind(path),
+			path.string().c_str(),
+			g_EntryPoint,
+			MakeCompileOptions()
+		);
+
+		if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+		{
+			outError = result.GetErrorMessage();
+			return false;
+		}
+
+		outSpirv.assign(result.begin(), result.end());
+		return true;
+	}
+
+	uint64_t ComputeCacheKey(const std::filesystem::path& path, const std::string& preprocessedSource)
+	{
+		uint64_t key = Hash::String(preprocessedSource);
+
+		Hash::CombineHash(key, Hash::String(COMPILER_IDENTITY));
+
+		Hash::Combine(key, GetShadercKind(path));
+		Hash::Combine(key, g_TargetEnvVersion);
+		Hash::Combine(key, g_OptimizationLevel);
+		Hash::CombineHash(key, Hash::String(g_EntryPoint));
+		return key;
+	}
+
+	std::string GetBinaryName(const std::filesystem::path& path, uint64_t cacheKey)
+	{
+		// Keep the extension, foo.vert and foo.frag must not share a binary
+		return std::format("{0}-{1:016x}.spv", path.filename().string(), cacheKey);
+	}
+
+	bool IsValidSPIRV(const std::vector<uint32_t>& spirv)
+	{
+		return !spirv.empty() && spirv.front() == SPIRV_MAGIC;
+	}
+
+	// ==============================================================================
+	// Manifest: header line, then per shader
+	// "<source name>\t<source hash>\t<binary name>[\t<dependency path>\t<dependency hash>]..."
+	// ==============================================================================
+	bool ReadManifest(const std::filesystem::path& path, Manifest& outManifest)
+	{
+		std::ifstream file(path);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		std::string line;
+		if (!std::getline(file, line) || line != MakeManifestHeader())
+		{
+			return false;
+		}
+
+		while (std::getline(file, line))
+		{
+			std::vector<std::string> fields;
+			std::istringstream stream(line);
+			for (std::string field; std::getline(stream, field, '\t'); )
+			{
+				fields.push_back(std::move(field));
+			}
+
+			// Name, hash, binary and (path, hash) pairs
+			if (fields.size() < 3 || (fields.size() - 3) % 2 != 0)
+			{
+				continue;
+			}
+
+			auto parseHash = [](const std::string& text, uint64_t& outHash)
+				{
+					auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), outHash, 16);
+					return ec == std::errc{};
+				};
+
+			ManifestEntry entry{ .binaryName = fields[2] };
+			bool valid = parseHash(fields[1], entry.sourceHash);
+			for (size_t i = 3; valid && i < fields.size(); i += 2)
+			{
+				ManifestDependency dependency{ .path = fields[i] };
+				valid = parseHash(fields[i + 1], dependency.hash);
+				entry.dependencies.push_back(std::move(dependency));
+			}
+
+			if (valid)
+			{
+				outManifest[fields[0]] = std::move(entry);
+			}
+		}
+		return true;
+	}
+
+	bool WriteManifest(const std::filesystem::path& path, const Manifest& manifest)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file << MakeManifestHeader() << '\n';
+		for (const auto& [sourceName, entry] : manifest)
+		{
+			file << std::format("{0}\t{1:016x}\t{2}", sourceName, entry.sourceHash, entry.binaryName);
+			for (const auto& dependency : entry.dependencies)
+			{
+				file << std::format("\t{0}\t{1:016x}", dependency.path, dependency.hash);
+			}
+			file << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+
+}
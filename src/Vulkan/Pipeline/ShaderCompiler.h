@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <unordered_map>
+#include <map>
+#include <cstdint>
+
+// GLSL -> SPIR-V compilation shared by the runtime (VulkanShader) and the offline
+// tiny_shader_compiler tool. Doesn't depend on the device or the log, errors are returned.
+namespace tiny_vulkan::ShaderCompiler {
+
+	// File name of the manifest written next to the prebuilt SPIR-V binaries.
+	constexpr const char* MANIFEST_NAME = "manifest.txt";
+
+	// Preprocessor defines of a shader variant (name -> value). Ordered, so equal sets compare and hash equal.
+	using Defines = std::map<std::string, std::string>;
+
+	// Compact identity of a define set, 0 for the default variant.
+	[[nodiscard]] uint64_t GetVariantKey(const Defines& defines);
+
+	// Absolute path with symlinks and dot segments resolved (as far as it exists).
+	// Dependencies always come out in this form, whether compiled at runtime or read from the manifest.
+	[[nodiscard]] std::filesystem::path CanonicalPath(const std::filesystem::path& path);
+
+	/**
+	 * @brief Expands defines and #include "file" (resolved relative to the including file).
+	 * outDependencies receives every file pulled in, directly or nested, without duplicates (canonical paths).
+	 */
+	[[nodiscard]] bool Preprocess(
+		const std::filesystem::path&			path,
+		const std::string&						source,
+		const Defines&							defines,
+		std::string&							outSource,
+		std::vector<std::filesystem::path>&		outDependencies,
+		std::string&							outError
+	);
+	[[nodiscard]] bool Compile(const std::filesystem::path& path, const std::string& preprocessedSource, std::vector<uint32_t>& outSpirv, std::string& outError);
+
+	/**
+	 * @brief Identity of a compilation: preprocessed source, stage, compile options,
+	 * compiler identity (TINY_SHADERC_IDENTITY) and target environment.
+	 */
+	[[nodiscard]] uint64_t ComputeCacheKey(const std::filesystem::path& path, const std::string& preprocessedSource);
+
+	// Versioned binary name, e.g. "shader.vert-<key>.spv".
+	[[nodiscard]] std::string GetBinaryName(const std::filesystem::path& path, uint64_t cacheKey);
+
+	[[nodiscard]] bool IsValidSPIRV(const std::vector<uint32_t>& spirv);
+
+	// ========================================================
+	// Prebuilt manifest
+	// ========================================================
+	struct ManifestDependency
+	{
+		std::string	path;				// Relative to the directory of the shader including it
+		uint64_t	hash{ 0 };			// Hash of the included file at build time
+	};
+
+	struct ManifestEntry
+	{
+		uint64_t						sourceHash{ 0 };	// Hash of the raw source file the binary was built from
+		std::string						binaryName;
+		std::vector<ManifestDependency>	dependencies;
+	};
+
+	// Keyed by source file name
+	using Manifest = std::unordered_map<std::string, ManifestEntry>;
+
+	[[nodiscard]] bool ReadManifest(const std::filesystem::path& path, Manifest& outManifest);
+	[[nodiscard]] bool WriteManifest(const std::filesystem::path& path, const Manifest& manifest);
+
+}
@@ -0,0 +1,260 @@
+#include "ShaderHotReload.h"
+#include "PipelineRegistry.h"
+#include "VulkanShader.h"
+#include "FileWatcher.h"
+#include "LifetimeManager.h"
+#include "LogSystem.h"
+
+namespace tiny_vulkan::ShaderHotReload {
+
+	namespace {
+		struct WatchedPipeline
+		{
+			VulkanPipelineBuilder				builder;	// Rebuilt with the recompiled shaders
+			GraphicsPipelineDesc				desc;		// Description currently registered
+			std::vector<std::weak_ptr<VulkanPipeline>> pipelines;	// Handed out or registered so far, all retargeted on reload
+			std::unordered_set<std::string>		files;		// Sources and includes, canonical
+		};
+
+		struct CompiledShader
+		{
+			std::vector<uint32_t>					spirv;
+			std::vector<std::filesystem::path>		dependencies;
+		};
+
+		struct PendingReload
+		{
+			size_t											index{ 0 };		// Into g_Watched
+			bool											stale{ false };	// Sources changed again while compiling
+			std::chrono::steady_clock::time_point			start;
+			std::future<std::optional<std::vector<CompiledShader>>> result;
+		};
+
+		// Internal linkage: accessible only within this translation unit.
+		std::mutex							g_Mutex;		// Guards g_Modified, filled by the watcher thread
+		std::unordered_set<std::string>		g_Modified;
+
+		// Render thread only
+		std::unique_ptr<FileWatcher>		g_Watcher;
+		std::vector<WatchedPipeline>		g_Watched;
+		std::vector<PendingReload>			g_Pending;
+		size_t								g_ReloadCount = 0;
+
+		// Same form as the shaders' dependency lists, so an edited include matches what was watched
+		std::string Canonical(const std::filesystem::path& path)
+		{
+			return ShaderCompiler::CanonicalPath(path).generic_string();
+		}
+
+		void Initialize()
+		{
+			if (g_Watcher)
+			{
+				return;
+			}
+
+			g_Watcher = std::make_unique<FileWatcher>([](const std::filesystem::path& path)
+				{
+					std::lock_guard lock(g_Mutex);
+					g_Modified.insert(path.generic_string());
+				});
+
+			// Before the pipelines and modules go away: stop watching and drain the compiles
+			LifetimeManager::PushFunction([]()
+				{
+					g_Watcher.reset();
+					for (auto& pending : g_Pending)
+					{
+						pending.result.wait();
+					}
+					g_Pending.clear();
+					g_Watched.clear();
+				});
+		}
+
+		void WatchFiles(WatchedPipeline& watched)
+		{
+			watched.files.clear();
+			for (const auto& shader : watched.builder.GetShaders())
+			{
+				watched.files.insert(Canonical(shader->GetPath()));
+				for (const auto& dependency : shader->GetDependencies())
+				{
+					watched.files.insert(Canonical(dependency));
+				}
+			}
+
+			for (const auto& file : watched.files)
+			{
+				g_Watcher->Watch(file);
+			}
+		}
+
+		PendingReload StartReload(size_t index)
+		{
+			std::vector<ShaderVariantDesc> variants;
+			for (const auto& shader : g_Watched[index].builder.GetShaders())
+			{
+				variants.push_back(shader->GetVariant());
+			}
+
+			PendingReload pending{};
+			pending.index = index;
+			pending.start = std::chrono::steady_clock::now();
+			pending.result = std::async(std::launch::async, [variants = std::move(variants)]() -> std::optional<std::vector<CompiledShader>>
+				{
+					std::vector<CompiledShader> compiled(variants.size());
+					for (size_t i = 0; i < variants.size(); ++i)
+					{
+						if (!VulkanShader::LoadSPIRV(variants[i].path, variants[i].defines, compiled[i].spirv, compiled[i].dependencies))
+						{
+							return std::nullopt;
+						}
+					}
+					return compiled;
+				});
+			return pending;
+		}
+
+		void ApplyReload(PendingReload& pending)
+		{
+			auto& watched = g_Watched[pending.index];
+
+			auto compiled = pending.result.get();
+			if (!compiled)
+			{
+				LOG_WARN("Shader reload failed, keeping the previous pipeline");
+				return;
+			}
+
+			std::vector<std::shared_ptr<VulkanShader>> shaders;
+			const auto& previous = watched.builder.GetShaders();
+			for (size_t i = 0; i < previous.size(); ++i)
+			{
+				auto& [spirv, dependencies] = (*compiled)[i];
+				shaders.push_back(VulkanShader::CreateFromSPIRV(previous[i]->GetVariant(), std::move(spirv), std::move(dependencies)));
+			}
+
+			VulkanPipelineBuilder builder = VulkanPipelineBuilder(watched.builder).ReplaceShaders(std::move(shaders));
+
+			auto replacement = builder.Build();
+			if (!replacement)
+			{
+				LOG_WARN("Pipeline rebuild failed, keeping the previous pipeline");
+				return;
+			}
+
+			auto desc = builder.MakeDesc();
+
+			// Shaders may #include other files now, watch those too
+			watched.builder = std::move(builder);
+			WatchFiles(watched);
+
+			if (desc == watched.desc)
+			{
+				LOG_DEBUG("Shader sources changed, the SPIR-V did not");
+				return;
+			}
+
+			if (auto old = PipelineRegistry::Unregister(watched.desc))
+			{
+				if (std::ranges::none_of(watched.pipelines, [&](const auto& pipeline) { return pipeline.lock() == old; }))
+				{
+					watched.pipelines.push_back(old);
+				}
+			}
+
+			// Everyone holding an earlier pipeline (or a view of it) follows the new one from now on, directly:
+			// retargeting every earlier one keeps views one link away however many reloads happen.
+			// The old handles are destroyed once the frames in flight are done with them.
+			std::erase_if(watched.pipelines, [](const auto& pipeline) { return pipeline.expired(); });
+			for (const auto& weak : watched.pipelines)
+			{
+				if (auto pipeline = weak.lock(); pipeline && pipeline != replacement)
+				{
+					pipeline->Retarget(replacement);
+				}
+			}
+			PipelineRegistry::ReleaseUnusedLayouts();
+			watched.desc = std::move(desc);
+
+			++g_ReloadCount;
+			const auto reloadTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - pending.start);
+			LOG_INFO(fmt::runtime("Pipeline {0:016x} reloaded in {1} ms"), watched.desc.GetHash(), reloadTime.count());
+		}
+	}
+
+	std::shared_ptr<VulkanPipeline> BuildWatched(const VulkanPipelineBuilder& builder)
+	{
+		Initialize();
+
+		auto pipeline = VulkanPipelineBuilder(builder).Build();
+		if (!pipeline)
+		{
+			return nullptr;
+		}
+
+		auto& watched = g_Watched.emplace_back(WatchedPipeline{ .builder = builder, .desc = builder.MakeDesc(), .pipelines = { pipeline }, .files = {} });
+		WatchFiles(watched);
+
+		return pipeline;
+	}
+
+	void Update()
+	{
+		std::unordered_set<std::string> modified;
+		{
+			std::lock_guard lock(g_Mutex);
+			modified.swap(g_Modified);
+		}
+
+		for (const auto& file : modified)
+		{
+			LOG_INFO(fmt::runtime("Shader source changed: {}"), file);
+		}
+
+		// Start a recompile for every pipeline depending on a modified file
+		for (size_t i = 0; i < g_Watched.size() && !modified.empty(); ++i)
+		{
+			const bool affected = std::ranges::any_of(modified, [&](const std::string& file) { return g_Watched[i].files.contains(file); });
+			if (!affected)
+			{
+				continue;
+			}
+
+			auto pending = std::ranges::find(g_Pending, i, &PendingReload::index);
+			if (pending != g_Pending.end())
+			{
+				pending->stale = true;
+				continue;
+			}
+			g_Pending.push_back(StartReload(i));
+		}
+
+		// Swap in the finished ones
+		for (auto it = g_Pending.begin(); it != g_Pending.end(); )
+		{
+			if (it->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				++it;
+				continue;
+			}
+
+			if (it->stale)
+			{
+				*it = StartReload(it->index);
+				++it;
+				continue;
+			}
+
+			ApplyReload(*it);
+			it = g_Pending.erase(it);
+		}
+	}
+
+	size_t GetReloadCount()
+	{
+		return g_ReloadCount;
+	}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "VulkanPipeline.h"
+
+#include <memory>
+
+// Rebuilds pipelines whose shader sources change on disk, without restarting the application.
+namespace tiny_vulkan::ShaderHotReload {
+
+	/**
+	 * @brief Builds the pipeline and watches its shaders (and the files they #include).
+	 * On a change the sources are recompiled on a background thread, the pipeline is rebuilt through
+	 * a copy of builder and swapped in at a frame boundary: the returned pipeline follows every rebuild.
+	 */
+	[[nodiscard]] std::shared_ptr<VulkanPipeline> BuildWatched(const VulkanPipelineBuilder& builder);
+
+	// Frame boundary: starts recompiles for modified files and swaps in the pipelines rebuilt since.
+	void Update();
+
+	[[nodiscard]] size_t GetReloadCount();
+
+}
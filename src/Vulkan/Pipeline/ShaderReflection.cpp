@@ -0,0 +1,141 @@
+#include "ShaderReflection.h"
+#include "LogSystem.h"
+
+#include <spirv_reflect.h>
+
+namespace tiny_vulkan::Reflection {
+
+	bool Reflect(const std::vector<uint32_t>& spirv, VkShaderStageFlagBits stage, ShaderReflection& outReflection)
+	{
+		SpvReflectShaderModule module{};
+		if (spvReflectCreateShaderModule(spirv.size() * sizeof(uint32_t), spirv.data(), &module) != SPV_REFLECT_RESULT_SUCCESS)
+		{
+			return false;
+		}
+
+		// Descriptor bindings
+		uint32_t setCount = 0;
+		spvReflectEnumerateDescriptorSets(&module, &setCount, nullptr);
+		std::vector<SpvReflectDescriptorSet*> sets(setCount);
+		spvReflectEnumerateDescriptorSets(&module, &setCount, sets.data());
+
+		for (const auto* set : sets)
+		{
+			for (uint32_t i = 0; i < set->binding_count; ++i)
+			{
+				const auto* binding = set->bindings[i];
+
+				ShaderReflection::Binding reflected{};
+				reflected.set = set->set;
+				reflected.binding = binding->binding;
+				reflected.type = static_cast<VkDescriptorType>(binding->descriptor_type); // Same values as VkDescriptorType
+				reflected.count = std::max(binding->count, 1u); // Runtime sized arrays report 0
+				reflected.stages = stage;
+				outReflection.bindings.push_back(reflected);
+			}
+		}
+
+		std::ranges::sort(outReflection.bindings, {}, [](const auto& binding) { return std::pair(binding.set, binding.binding); });
+
+		// Push constants
+		uint32_t blockCount = 0;
+		spvReflectEnumeratePushConstantBlocks(&module, &blockCount, nullptr);
+		std::vector<SpvReflectBlockVariable*> blocks(blockCount);
+		spvReflectEnumeratePushConstantBlocks(&module, &blockCount, blocks.data());
+
+		for (const auto* block : blocks)
+		{
+			VkPushConstantRange range{};
+			range.stageFlags = stage;
+			range.offset = block->offset;
+			range.size = block->size;
+			outReflection.pushConstants.push_back(range);
+		}
+
+		// Workgroup size
+		if (stage == VK_SHADER_STAGE_COMPUTE_BIT && module.entry_point_count > 0)
+		{
+			const auto& localSize = module.entry_points[0].local_size;
+			outReflection.localSize = { localSize.x, localSize.y, localSize.z };
+		}
+
+		spvReflectDestroyShaderModule(&module);
+		return true;
+	}
+
+	bool Merge(ShaderReflection& merged, const ShaderReflection& other)
+	{
+		bool compatible = true;
+
+		for (const auto& binding : other.bindings)
+		{
+			auto it = std::ranges::find_if(merged.bindings, [&binding](const auto& existing)
+				{
+					return existing.set == binding.set && existing.binding == binding.binding;
+				});
+
+			if (it == merged.bindings.end())
+			{
+				merged.bindings.push_back(binding);
+				continue;
+			}
+
+			if (it->type != binding.type || it->count != binding.count)
+			{
+				LOG_ERROR(fmt::runtime("Shader stages disagree on set {0} binding {1}"), binding.set, binding.binding);
+				compatible = false;
+				continue;
+			}
+			it->stages |= binding.stages;
+		}
+
+		std::ranges::sort(merged.bindings, {}, [](const auto& binding) { return std::pair(binding.set, binding.binding); });
+
+		// A stage may appear in one range only, so all blocks share a single range
+		for (const auto& range : other.pushConstants)
+		{
+			if (merged.pushConstants.empty())
+			{
+				merged.pushConstants.push_back(range);
+				continue;
+			}
+
+			auto& combined = merged.pushConstants.front();
+			const uint32_t begin = std::min(combined.offset, range.offset);
+			const uint32_t end = std::max(combined.offset + combined.size, range.offset + range.size);
+			combined.offset = begin;
+			combined.size = end - begin;
+			combined.stageFlags |= range.stageFlags;
+		}
+
+		if (other.localSize[0] != 0)
+		{
+			merged.localSize = other.localSize;
+		}
+
+		return compatible;
+	}
+
+	std::vector<std::vector<VkDescriptorSetLayoutBinding>> GetSetLayoutBindings(const ShaderReflection& reflection)
+	{
+		std::vector<std::vector<VkDescriptorSetLayoutBinding>> sets;
+
+		for (const auto& binding : reflection.bindings)
+		{
+			if (binding.set >= sets.size())
+			{
+				sets.resize(binding.set + 1);
+			}
+
+			VkDescriptorSetLayoutBinding layoutBinding{};
+			layoutBinding.binding = binding.binding;
+			layoutBinding.descriptorType = binding.type;
+			layoutBinding.descriptorCount = binding.count;
+			layoutBinding.stageFlags = binding.stages;
+			sets[binding.set].push_back(layoutBinding);
+		}
+
+		return sets;
+	}
+
+}
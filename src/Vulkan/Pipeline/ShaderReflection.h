@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace tiny_vulkan {
+
+	// Resource interface of a shader (or of several stages, once merged), read from its SPIR-V.
+	struct ShaderReflection
+	{
+		struct Binding
+		{
+			uint32_t			set{ 0 };
+			uint32_t			binding{ 0 };
+			VkDescriptorType	type{ VK_DESCRIPTOR_TYPE_MAX_ENUM };
+			uint32_t			count{ 1 };
+			VkShaderStageFlags	stages{ 0 };
+		};
+
+		std::vector<Binding>				bindings;		// Sorted by (set, binding)
+		std::vector<VkPushConstantRange>	pushConstants;
+		std::array<uint32_t, 3>				localSize{ 0, 0, 0 }; // Compute only
+	};
+
+}
+
+namespace tiny_vulkan::Reflection {
+
+	[[nodiscard]] bool Reflect(const std::vector<uint32_t>& spirv, VkShaderStageFlagBits stage, ShaderReflection& outReflection);
+
+	/**
+	 * @brief Accumulates other into merged: bindings shared across stages get their stage flags combined,
+	 * push constants collapse into one range visible to every stage using them.
+	 * Returns false when two stages declare the same binding with different types.
+	 */
+	[[nodiscard]] bool Merge(ShaderReflection& merged, const ShaderReflection& other);
+
+	// Bindings of each set, indexed by set number. Sets skipped by the shaders are empty.
+	[[nodiscard]] std::vector<std::vector<VkDescriptorSetLayoutBinding>> GetSetLayoutBindings(const ShaderReflection& reflection);
+
+}
@@ -0,0 +1,125 @@
+#include "ShaderVariants.h"
+#include "LogSystem.h"
+#include "Hash.h"
+#include "LifetimeManager.h"
+
+namespace tiny_vulkan::ShaderVariants {
+
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		std::mutex g_Mutex;
+		std::unordered_map<uint64_t, std::shared_ptr<VulkanShader>> g_Variants;
+		bool g_CleanupRegistered = false;
+
+		// The cached modules are released with the other runtime resources, while the device is alive.
+		// Called with g_Mutex held.
+		void RegisterCleanup()
+		{
+			if (g_CleanupRegistered)
+			{
+				return;
+			}
+			g_CleanupRegistered = true;
+
+			LifetimeManager::PushFunction([]()
+				{
+					std::lock_guard lock(g_Mutex);
+					g_Variants.clear();
+				});
+		}
+
+		uint64_t MakeKey(const std::filesystem::path& path, const ShaderCompiler::Defines& defines)
+		{
+			uint64_t key = Hash::String(std::filesystem::weakly_canonical(path).string());
+			Hash::Combine(key, ShaderCompiler::GetVariantKey(defines));
+			return key;
+		}
+	}
+
+	std::shared_ptr<VulkanShader> Get(const std::filesystem::path& path, const ShaderCompiler::Defines& defines)
+	{
+		const uint64_t key = MakeKey(path, defines);
+		{
+			std::lock_guard lock(g_Mutex);
+			auto it = g_Variants.find(key);
+			if (it != g_Variants.end())
+			{
+				return it->second;
+			}
+		}
+
+		// Compiled without the lock, other lookups go on meanwhile
+		auto shader = std::make_shared<VulkanShader>(path, defines);
+
+		// Another thread may have compiled the same variant: the first one inserted wins
+		std::lock_guard lock(g_Mutex);
+		RegisterCleanup();
+		return g_Variants.emplace(key, std::move(shader)).first->second;
+	}
+
+	void Precompile(const std::vector<ShaderVariantDesc>& variants)
+	{
+		std::vector<ShaderVariantDesc> missing;
+		std::vector<uint64_t> keys;
+		{
+			std::lock_guard lock(g_Mutex);
+			for (const auto& variant : variants)
+			{
+				const uint64_t key = MakeKey(variant.path, variant.defines);
+				if (!g_Variants.contains(key) && std::ranges::find(keys, key) == keys.end())
+				{
+					missing.push_back(variant);
+					keys.push_back(key);
+				}
+			}
+		}
+
+		if (missing.empty())
+		{
+			return;
+		}
+
+		auto shaders = VulkanShader::CompileBatch(missing);
+
+		std::lock_guard lock(g_Mutex);
+		RegisterCleanup();
+		for (size_t i = 0; i < shaders.size(); ++i)
+		{
+			g_Variants.emplace(keys[i], std::move(shaders[i]));
+		}
+
+		LOG_DEBUG(fmt::runtime("Precompiled {0} shader variants ({1} cached)"), missing.size(), g_Variants.size());
+	}
+
+	std::vector<ShaderVariantDesc> MakePermutations(
+		const std::filesystem::path&		path,
+		const std::vector<std::string>&		toggles,
+		const ShaderCompiler::Defines&		base)
+	{
+		std::vector<ShaderVariantDesc> variants;
+
+		const size_t count = size_t(1) << toggles.size();
+		variants.reserve(count);
+		for (size_t mask = 0; mask < count; ++mask)
+		{
+			ShaderVariantDesc variant{ .path = path, .defines = base };
+			for (size_t bit = 0; bit < toggles.size(); ++bit)
+			{
+				if (mask & (size_t(1) << bit))
+				{
+					variant.defines[toggles[bit]] = "1";
+				}
+			}
+			variants.push_back(std::move(variant));
+		}
+
+		return variants;
+	}
+
+	size_t GetVariantCount()
+	{
+		std::lock_guard lock(g_Mutex);
+		return g_Variants.size();
+	}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "VulkanShader.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tiny_vulkan::ShaderVariants {
+
+	/**
+	 * @brief Returns the shader module of (path, defines), compiling it on first use.
+	 * Variants share their GLSL source, e.g. { "NO_NORMAL_MAP", "1" } selects a specialized fast path.
+	 */
+	[[nodiscard]] std::shared_ptr<VulkanShader> Get(const std::filesystem::path& path, const ShaderCompiler::Defines& defines = {});
+
+	// Compiles every declared variant not cached yet in one parallel batch (e.g. at load time).
+	void Precompile(const std::vector<ShaderVariantDesc>& variants);
+
+	/**
+	 * @brief All on/off combinations of toggles on top of base, each enabled toggle defined as "1".
+	 * N toggles produce 2^N variants.
+	 */
+	[[nodiscard]] std::vector<ShaderVariantDesc> MakePermutations(
+		const std::filesystem::path&		path,
+		const std::vector<std::string>&		toggles,
+		const ShaderCompiler::Defines&		base = {}
+	);
+
+	[[nodiscard]] size_t GetVariantCount();
+
+}
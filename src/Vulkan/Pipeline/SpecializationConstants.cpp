@@ -0,0 +1,74 @@
+#include "SpecializationConstants.h"
+#include "LogSystem.h"
+#include "Hash.h"
+
+namespace tiny_vulkan {
+
+	void SpecializationConstants::SetBytes(uint32_t constantId, const void* data, size_t size)
+	{
+		auto it = std::ranges::lower_bound(m_Entries, constantId, {}, &VkSpecializationMapEntry::constantID);
+
+		// Overwrite an existing constant in place
+		if (it != m_Entries.end() && it->constantID == constantId)
+		{
+			if (it->size != size)
+			{
+				LOG_ERROR(fmt::runtime("Specialization constant {0} set with size {1}, previously {2}"), constantId, size, it->size);
+				return;
+			}
+			std::memcpy(m_Data.data() + it->offset, data, size);
+			return;
+		}
+
+		VkSpecializationMapEntry entry{};
+		entry.constantID = constantId;
+		entry.offset = (uint32_t)m_Data.size();
+		entry.size = size;
+		m_Entries.insert(it, entry);
+
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		m_Data.insert(m_Data.end(), bytes, bytes + size);
+	}
+
+	VkSpecializationInfo SpecializationConstants::GetInfo() const
+	{
+		VkSpecializationInfo info{};
+		info.mapEntryCount = (uint32_t)m_Entries.size();
+		info.pMapEntries = m_Entries.data();
+		info.dataSize = m_Data.size();
+		info.pData = m_Data.data();
+		return info;
+	}
+
+	uint64_t SpecializationConstants::GetHash() const
+	{
+		uint64_t seed = Hash::FNV_OFFSET_BASIS;
+		for (const auto& entry : m_Entries)
+		{
+			Hash::Combine(seed, entry.constantID);
+			Hash::CombineHash(seed, Hash::Bytes(m_Data.data() + entry.offset, entry.size));
+		}
+		return seed;
+	}
+
+	bool SpecializationConstants::operator==(const SpecializationConstants& other) const
+	{
+		if (m_Entries.size() != other.m_Entries.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < m_Entries.size(); ++i)
+		{
+			const auto& a = m_Entries[i];
+			const auto& b = other.m_Entries[i];
+			if (a.constantID != b.constantID || a.size != b.size ||
+				std::memcmp(m_Data.data() + a.offset, other.m_Data.data() + b.offset, a.size) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+}
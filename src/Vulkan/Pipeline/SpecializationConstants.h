@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <type_traits>
+#include <vulkan/vulkan.h>
+
+namespace tiny_vulkan {
+
+	/**
+	 * @brief Typed set of specialization constants for one shader stage.
+	 * Maps to `layout(constant_id = N) const ...` in GLSL, e.g. workgroup sizes, feature toggles or light counts.
+	 * Values are baked at pipeline creation and are part of the pipeline key.
+	 */
+	class SpecializationConstants
+	{
+	public:
+		SpecializationConstants() = default;
+
+		// bool is stored as VkBool32, other scalars must be 32 or 64 bit (int, uint, float, double, int64).
+		template<typename T>
+		SpecializationConstants& Set(uint32_t constantId, T value)
+		{
+			static_assert(std::is_arithmetic_v<T>, "Specialization constants must be scalars");
+
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				const VkBool32 boolValue = value ? VK_TRUE : VK_FALSE;
+				SetBytes(constantId, &boolValue, sizeof(VkBool32));
+			}
+			else
+			{
+				static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Specialization constants must be 32 or 64 bit");
+				SetBytes(constantId, &value, sizeof(T));
+			}
+			return *this;
+		}
+
+		[[nodiscard]] bool IsEmpty() const { return m_Entries.empty(); }
+
+		// Points into this object, valid while it is alive and unmodified.
+		[[nodiscard]] VkSpecializationInfo GetInfo() const;
+
+		// Independent of the order the constants were set in.
+		[[nodiscard]] uint64_t GetHash() const;
+
+		[[nodiscard]] bool operator==(const SpecializationConstants& other) const;
+
+	private:
+		void SetBytes(uint32_t constantId, const void* data, size_t size);
+
+	private:
+		std::vector<VkSpecializationMapEntry>	m_Entries; // Sorted by constantID
+		std::vector<uint8_t>					m_Data;
+	};
+
+}
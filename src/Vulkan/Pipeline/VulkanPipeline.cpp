@@ -1,10 +1,123 @@
 #include "VulkanPipeline.h"
+#include "PipelineRegistry.h"
+#include "PipelineLibrary.h"
+#include "DynamicState.h"
+#include "VulkanExtensions.h"
 #include "VulkanCore.h"
-#include "LifetimeManager.h" 
 #include "LogSystem.h"
+#include "Hash.h"
 
 namespace tiny_vulkan {
 
+	// ==============================================================================
+	// Pipeline Descriptions
+	// ==============================================================================
+	bool DescriptorSetLayoutDesc::operator==(const DescriptorSetLayoutDesc& other) const
+	{
+		auto bindingEqual = [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+			{
+				return a.binding == b.binding
+					&& a.descriptorType == b.descriptorType
+					&& a.descriptorCount == b.descriptorCount
+					&& a.stageFlags == b.stageFlags
+					&& a.pImmutableSamplers == b.pImmutableSamplers;
+			};
+
+		return std::ranges::equal(bindings, other.bindings, bindingEqual);
+	}
+
+	uint64_t DescriptorSetLayoutDesc::GetHash() const
+	{
+		uint64_t seed = Hash::FNV_OFFSET_BASIS;
+		for (const auto& binding : bindings)
+		{
+			Hash::Combine(seed, binding.binding);
+			Hash::Combine(seed, binding.descriptorType);
+			Hash::Combine(seed, binding.descriptorCount);
+			Hash::Combine(seed, binding.stageFlags);
+			Hash::Combine(seed, binding.pImmutableSamplers);
+		}
+		return seed;
+	}
+
+	bool PipelineLayoutDesc::operator==(const PipelineLayoutDesc& other) const
+	{
+		auto rangeEqual = [](const VkPushConstantRange& a, const VkPushConstantRange& b)
+			{
+				return a.stageFlags == b.stageFlags && a.offset == b.offset && a.size == b.size;
+			};
+
+		return descriptorSetLayouts == other.descriptorSetLayouts
+			&& std::ranges::equal(pushConstantRanges, other.pushConstantRanges, rangeEqual);
+	}
+
+	uint64_t PipelineLayoutDesc::GetHash() const
+	{
+		uint64_t seed = Hash::FNV_OFFSET_BASIS;
+		for (auto setLayout : descriptorSetLayouts)
+		{
+			Hash::Combine(seed, setLayout);
+		}
+		for (const auto& range : pushConstantRanges)
+		{
+			Hash::Combine(seed, range.stageFlags);
+			Hash::Combine(seed, range.offset);
+			Hash::Combine(seed, range.size);
+		}
+		return seed;
+	}
+
+	bool GraphicsPipelineDesc::operator==(const GraphicsPipelineDesc& other) const
+	{
+		return type == other.type
+			&& backend == other.backend
+			&& shaders == other.shaders
+			&& layout == other.layout
+			&& colorFormats == other.colorFormats
+			&& depthFormat == other.depthFormat
+			&& topology == other.topology
+			&& polygonMode == other.polygonMode
+			&& cullMode == other.cullMode
+			&& frontFace == other.frontFace
+			&& depthTestEnable == other.depthTestEnable
+			&& depthWriteEnable == other.depthWriteEnable
+			&& depthCompareOp == other.depthCompareOp
+			&& blendMode == other.blendMode
+			&& dynamicState == other.dynamicState;
+	}
+
+	uint64_t GraphicsPipelineDesc::GetHash() const
+	{
+		uint64_t seed = Hash::FNV_OFFSET_BASIS;
+		Hash::Combine(seed, type);
+		Hash::Combine(seed, backend);
+		for (const auto& shader : shaders)
+		{
+			Hash::Combine(seed, shader.hash);
+			Hash::Combine(seed, shader.stage);
+			Hash::Combine(seed, shader.specialization);
+			Hash::Combine(seed, shader.variant);
+		}
+		Hash::CombineHash(seed, layout.GetHash());
+		for (auto format : colorFormats)
+		{
+			Hash::Combine(seed, format);
+		}
+		Hash::Combine(seed, depthFormat);
+		Hash::Combine(seed, topology);
+		Hash::Combine(seed, polygonMode);
+		Hash::Combine(seed, cullMode);
+		Hash::Combine(seed, frontFace);
+		Hash::Combine(seed, depthTestEnable);
+		Hash::Combine(seed, depthWriteEnable);
+		Hash::Combine(seed, depthCompareOp);
+		Hash::Combine(seed, blendMode);
+		Hash::Combine(seed, dynamicState.extended);
+		Hash::Combine(seed, dynamicState.blend);
+		Hash::Combine(seed, dynamicState.polygonMode);
+		return seed;
+	}
+
 	// ==============================================================================
 	// VulkanPipeline Implementation
 	// ==============================================================================
@@ -15,6 +128,92 @@ namespace tiny_vulkan {
 
 	}
 
+	VulkanPipeline::VulkanPipeline(const std::vector<VkShaderEXT>& shaderObjects, const std::vector<VkShaderStageFlagBits>& stages, VkPipelineLayout layout)
+		: m_PipelineLayout(layout)
+		, m_Backend(PipelineBackend::SHADER_OBJECT)
+		, m_ShaderObjects(shaderObjects)
+		, m_ShaderStages(stages)
+	{
+
+	}
+
+	std::shared_ptr<VulkanPipeline> VulkanPipeline::CreateDerived(std::shared_ptr<VulkanPipeline> base, const RasterState& defaults)
+	{
+		auto derived = std::make_shared<VulkanPipeline>(VK_NULL_HANDLE, base->GetLayout());
+		derived->SetDynamicRasterState(defaults, base->m_DynamicState, base->m_ColorAttachmentCount);
+		derived->m_Base = std::move(base);
+		return derived;
+	}
+
+	void VulkanPipeline::Retarget(std::shared_ptr<VulkanPipeline> replacement)
+	{
+		// Point at the pipeline owning the handles, so views never chain through earlier replacements
+		while (replacement && replacement->m_Base)
+		{
+			replacement = replacement->m_Base;
+		}
+		if (replacement.get() == this)
+		{
+			return;
+		}
+
+		// Frames in flight may still bind the old handles, they go through the deletion queue
+		PipelineRegistry::RetirePipeline(std::exchange(m_Pipeline, VK_NULL_HANDLE));
+		for (auto shaderObject : m_ShaderObjects)
+		{
+			PipelineRegistry::RetireShaderObject(shaderObject);
+		}
+
+		m_ShaderObjects.clear();
+		m_ShaderStages.clear();
+		m_PipelineLayout = VK_NULL_HANDLE;
+		m_Base = std::move(replacement);
+	}
+
+	void VulkanPipeline::SetDynamicRasterState(const RasterState& defaults, const DynamicStateSet& dynamicState, uint32_t colorAttachmentCount)
+	{
+		m_RasterState = defaults;
+		m_DynamicState = dynamicState;
+		m_ColorAttachmentCount = colorAttachmentCount;
+	}
+
+	void VulkanPipeline::CmdBind(VkCommandBuffer cmdBuffer) const
+	{
+		const auto& source = GetRoot();
+
+		if (source.m_Backend == PipelineBackend::SHADER_OBJECT)
+		{
+			Extensions::CmdBindShadersEXT(cmdBuffer, (uint32_t)source.m_ShaderStages.size(), source.m_ShaderStages.data(), source.m_ShaderObjects.data());
+
+			// Shader objects have no baked state at all
+			if (source.m_BindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS)
+			{
+				DynamicState::CmdSetShaderObjectState(cmdBuffer, m_RasterState, m_ColorAttachmentCount);
+			}
+			return;
+		}
+
+		vkCmdBindPipeline(cmdBuffer, source.m_BindPoint, source.m_Pipeline);
+
+		if (m_DynamicState.Any())
+		{
+			DynamicState::CmdSetRasterState(cmdBuffer, m_RasterState, m_DynamicState, m_ColorAttachmentCount);
+		}
+	}
+
+	void VulkanPipeline::CmdSetViewportAndScissor(VkCommandBuffer cmdBuffer, const VkViewport& viewport, const VkRect2D& scissor) const
+	{
+		if (GetBackend() == PipelineBackend::SHADER_OBJECT)
+		{
+			vkCmdSetViewportWithCount(cmdBuffer, 1, &viewport);
+			vkCmdSetScissorWithCount(cmdBuffer, 1, &scissor);
+			return;
+		}
+
+		vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+	}
+
 	// ==============================================================================
 	// PipelineBuilder 
 	// ==============================================================================
@@ -24,6 +223,12 @@ namespace tiny_vulkan {
 		return *this;
 	}
 
+	VulkanPipelineBuilder& VulkanPipelineBuilder::SetBackend(PipelineBackend backend)
+	{
+		m_Backend = backend;
+		return *this;
+	}
+
 	VulkanPipelineBuilder& VulkanPipelineBuilder::AddDescriptorLayout(VkDescriptorSetLayout layout)
 	{
 		m_DescriptorSetLayouts.push_back(layout);
@@ -36,6 +241,12 @@ namespace tiny_vulkan {
 		return *this;
 	}
 
+	VulkanPipelineBuilder& VulkanPipelineBuilder::UseReflection(bool enable)
+	{
+		m_UseReflection = enable;
+		return *this;
+	}
+
 	VulkanPipelineBuilder& VulkanPipelineBuilder::AddShader(std::shared_ptr<VulkanShader> shader)
 	{
 		if (shader)
@@ -45,6 +256,28 @@ namespace tiny_vulkan {
 		return *this;
 	}
 
+	VulkanPipelineBuilder& VulkanPipelineBuilder::ReplaceShaders(std::vector<std::shared_ptr<VulkanShader>> shaders)
+	{
+		m_Shaders = std::move(shaders);
+		return *this;
+	}
+
+	VulkanPipelineBuilder& VulkanPipelineBuilder::SetSpecializationConstants(VkShaderStageFlagBits stage, const SpecializationConstants& constants)
+	{
+		m_Specializations[stage] = constants;
+		return *this;
+	}
+
+	const SpecializationConstants* VulkanPipelineBuilder::FindSpecialization(VkShaderStageFlagBits stage) const
+	{
+		auto it = m_Specializations.find(stage);
+		if (it == m_Specializations.end() || it->second.IsEmpty())
+		{
+			return nullptr;
+		}
+		return &it->second;
+	}
+
 	VulkanPipelineBuilder& VulkanPipelineBuilder::SetColorAttachmentFormats(const std::vector<VkFormat>& formats)
 	{
 		m_ColorFormats = formats;
@@ -87,46 +320,308 @@ namespace tiny_vulkan {
 		return *this;
 	}
 
+	VulkanPipelineBuilder& VulkanPipelineBuilder::EnableDepthWrite(bool enable)
+	{
+		m_DepthWriteEnable = enable;
+		return *this;
+	}
+
+	VulkanPipelineBuilder& VulkanPipelineBuilder::SetDepthCompareOp(VkCompareOp compareOp)
+	{
+		m_DepthCompareOp = compareOp;
+		return *this;
+	}
+
 	VulkanPipelineBuilder& VulkanPipelineBuilder::SetBlendMode(BlendMode mode)
 	{
 		m_BlendMode = mode;
 		return *this;
 	}
 
+	VulkanPipelineBuilder& VulkanPipelineBuilder::EnableDynamicState(bool enable)
+	{
+		m_DynamicState = enable;
+		return *this;
+	}
+
+	GraphicsPipelineDesc VulkanPipelineBuilder::MakeDesc() const
+	{
+		GraphicsPipelineDesc desc{};
+		desc.type = m_Type;
+		desc.backend = ResolveBackend();
+		desc.layout = ResolveLayout();
+
+		desc.shaders.reserve(m_Shaders.size());
+		for (const auto& shader : m_Shaders)
+		{
+			const auto* specialization = FindSpecialization(shader->GetStage());
+			desc.shaders.push_back(ShaderIdentity{
+				.hash = shader->GetHash(),
+				.stage = shader->GetStage(),
+				.specialization = specialization ? specialization->GetHash() : 0,
+				.variant = shader->GetVariantKey()
+				});
+		}
+
+		// Compute pipelines ignore graphics state, keep the defaults so it doesn't split the key
+		if (m_Type == PipelineType::GRAPHICS)
+		{
+			const RasterState raster = MakeRasterState();
+
+			desc.colorFormats = m_ColorFormats;
+			desc.depthFormat = m_DepthFormat;
+			desc.dynamicState = ResolveDynamicState();
+
+			// Dynamic groups stay at their defaults, so they don't split the key
+			if (desc.dynamicState.extended)
+			{
+				desc.topology = DynamicState::GetTopologyClass(raster.topology);
+			}
+			else
+			{
+				desc.topology = raster.topology;
+				desc.cullMode = raster.cullMode;
+				desc.frontFace = raster.frontFace;
+				desc.depthTestEnable = raster.depthTestEnable;
+				desc.depthWriteEnable = raster.depthWriteEnable;
+				desc.depthCompareOp = raster.depthCompareOp;
+			}
+
+			if (!desc.dynamicState.polygonMode)
+			{
+				desc.polygonMode = raster.polygonMode;
+			}
+
+			if (!desc.dynamicState.blend)
+			{
+				desc.blendMode = raster.blendMode;
+			}
+		}
+
+		return desc;
+	}
+
+	RasterState VulkanPipelineBuilder::MakeRasterState() const
+	{
+		RasterState state{};
+		state.topology = m_Topology;
+		state.polygonMode = m_PolygonMode;
+		state.cullMode = m_CullMode;
+		state.frontFace = m_FrontFace;
+		state.depthTestEnable = m_DepthTestEnable;
+		state.depthWriteEnable = m_DepthTestEnable && m_DepthWriteEnable;
+		state.depthCompareOp = m_DepthCompareOp;
+		state.blendMode = m_BlendMode;
+		return state;
+	}
+
+	DynamicStateSet VulkanPipelineBuilder::ResolveDynamicState() const
+	{
+		DynamicStateSet dynamicState{};
+		if (m_Type != PipelineType::GRAPHICS || (!m_DynamicState && ResolveBackend() != PipelineBackend::SHADER_OBJECT))
+		{
+			return dynamicState;
+		}
+
+		// Shader objects set every group on the command buffer
+		if (ResolveBackend() == PipelineBackend::SHADER_OBJECT)
+		{
+			return DynamicStateSet{ .extended = true, .blend = true, .polygonMode = true };
+		}
+
+		const auto& caps = VulkanCore::GetCapabilities();
+		dynamicState.extended = true; // Core since Vulkan 1.3
+		dynamicState.blend = caps.dynamicBlendState;
+		dynamicState.polygonMode = caps.dynamicPolygonMode;
+		return dynamicState;
+	}
+
+	VulkanPipelineBuilder& VulkanPipelineBuilder::UsePipelineLibrary(bool enable)
+	{
+		m_UsePipelineLibrary = enable;
+		return *this;
+	}
+
+	VulkanPipelineBuilder& VulkanPipelineBuilder::EnableBackgroundOptimization(bool enable)
+	{
+		m_BackgroundOptimization = enable;
+		return *this;
+	}
+
 	std::shared_ptr<VulkanPipeline> VulkanPipelineBuilder::Build()
 	{
+		auto desc = MakeDesc();
+
+		// Reuse an identical pipeline if one was already built
+		if (auto cached = PipelineRegistry::Find(desc))
+		{
+			// Same PSO, but this material may want other values for the dynamic state
+			const RasterState raster = MakeRasterState();
+			if (desc.dynamicState.Any() && !(cached->GetRasterState() == raster))
+			{
+				return VulkanPipeline::CreateDerived(cached, raster);
+			}
+			return cached;
+		}
+
 		// Create pipeline layout
-		if (!BuildPipelineLayout())
+		if (!BuildPipelineLayout(desc.layout))
 		{
 			return nullptr;
 		}
 
+		if (m_Backend != desc.backend)
+		{
+			LOG_WARN("VK_EXT_shader_object is not available, falling back to a pipeline");
+		}
+
 		// Create specific pipeline
-		switch (m_Type)
+		const auto buildStart = std::chrono::steady_clock::now();
+
+		std::shared_ptr<VulkanPipeline> pipeline;
+		if (desc.backend == PipelineBackend::SHADER_OBJECT)
 		{
-		case PipelineType::COMPUTE:  return BuildCompute();
-		case PipelineType::GRAPHICS: return BuildGraphics();
-		default:
-			return nullptr;
+			pipeline = BuildShaderObjects(desc.layout);
+		}
+		else
+		{
+			switch (m_Type)
+			{
+			case PipelineType::COMPUTE:  pipeline = BuildCompute();  break;
+			case PipelineType::GRAPHICS: pipeline = BuildGraphics(desc); break;
+			default:
+				return nullptr;
+			}
+		}
+
+		if (pipeline)
+		{
+			const auto buildTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - buildStart);
+			LOG_DEBUG(fmt::runtime("Pipeline {0:016x} created in {1} us ({2})"),
+				desc.GetHash(),
+				buildTime.count(),
+				desc.backend == PipelineBackend::SHADER_OBJECT ? "shader object" : "pipeline"
+			);
+
+			pipeline->SetBindPoint(m_Type == PipelineType::COMPUTE ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_GRAPHICS);
+			pipeline->SetDynamicRasterState(MakeRasterState(), desc.dynamicState, (uint32_t)m_ColorFormats.size());
+			PipelineRegistry::Register(desc, pipeline);
 		}
+
+		return pipeline;
 	}
 
-	bool VulkanPipelineBuilder::BuildPipelineLayout()
+	PipelineLayoutDesc VulkanPipelineBuilder::ResolveLayout() const
 	{
-		auto device = VulkanCore::GetDevice();
+		PipelineLayoutDesc layoutDesc{};
+		layoutDesc.descriptorSetLayouts = m_DescriptorSetLayouts;
+		layoutDesc.pushConstantRanges = m_Ranges;
+
+		// Layouts added by hand take precedence
+		const bool reflectSets = m_UseReflection && m_DescriptorSetLayouts.empty();
+		const bool reflectRanges = m_UseReflection && m_Ranges.empty();
+		if (!reflectSets && !reflectRanges)
+		{
+			return layoutDesc;
+		}
+
+		ShaderReflection merged{};
+		for (const auto& shader : m_Shaders)
+		{
+			if (!Reflection::Merge(merged, shader->GetReflection()))
+			{
+				LOG_WARN("Reflected shader interfaces are incompatible, the pipeline layout may be invalid");
+			}
+		}
+
+		if (reflectSets)
+		{
+			for (auto& bindings : Reflection::GetSetLayoutBindings(merged))
+			{
+				layoutDesc.descriptorSetLayouts.push_back(PipelineRegistry::GetOrCreateSetLayout(DescriptorSetLayoutDesc{ std::move(bindings) }));
+			}
+		}
+
+		if (reflectRanges)
+		{
+			layoutDesc.pushConstantRanges = std::move(merged.pushConstants);
+		}
+
+		return layoutDesc;
+	}
+
+	bool VulkanPipelineBuilder::BuildPipelineLayout(const PipelineLayoutDesc& layoutDesc)
+	{
+		m_PipelineLayout = PipelineRegistry::GetOrCreateLayout(layoutDesc);
+
+		return m_PipelineLayout != VK_NULL_HANDLE;
+	}
+
+	PipelineBackend VulkanPipelineBuilder::ResolveBackend() const
+	{
+		if (m_Backend == PipelineBackend::SHADER_OBJECT && !VulkanCore::GetCapabilities().shaderObject)
+		{
+			return PipelineBackend::PIPELINE;
+		}
+		return m_Backend;
+	}
+
+	std::shared_ptr<VulkanPipeline> VulkanPipelineBuilder::BuildShaderObjects(const PipelineLayoutDesc& layoutDesc)
+	{
+		if (m_Shaders.empty()) return nullptr;
 
-		VkPipelineLayoutCreateInfo info{};
-		info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		info.pSetLayouts = m_DescriptorSetLayouts.data();
-		info.setLayoutCount = (uint32_t)m_DescriptorSetLayouts.size();
-		info.pPushConstantRanges = m_Ranges.data();
-		info.pushConstantRangeCount = (uint32_t)m_Ranges.size();
+		// Every graphics stage gets bound, unused ones as VK_NULL_HANDLE
+		std::vector<VkShaderStageFlagBits> stages;
+		if (m_Type == PipelineType::COMPUTE)
+		{
+			stages = { VK_SHADER_STAGE_COMPUTE_BIT };
+		}
+		else
+		{
+			stages = {
+				VK_SHADER_STAGE_VERTEX_BIT,
+				VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+				VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
+				VK_SHADER_STAGE_GEOMETRY_BIT,
+				VK_SHADER_STAGE_FRAGMENT_BIT
+			};
+		}
 
-		CHECK_VK_RES(vkCreatePipelineLayout(device, &info, nullptr, &m_PipelineLayout));
+		bool hasFragment = std::ranges::any_of(m_Shaders, [](const auto& shader) { return shader->GetStage() == VK_SHADER_STAGE_FRAGMENT_BIT; });
 
-		LifetimeManager::PushFunction(vkDestroyPipelineLayout, device, m_PipelineLayout, nullptr);
+		std::vector<VkShaderEXT> shaderObjects(stages.size(), VK_NULL_HANDLE);
+		for (const auto& shader : m_Shaders)
+		{
+			auto it = std::ranges::find(stages, shader->GetStage());
+			if (it == stages.end())
+			{
+				LOG_WARN(fmt::runtime("Shader stage {} is not supported by the shader object backend"), string_VkShaderStageFlagBits(shader->GetStage()));
+				continue;
+			}
+
+			VkShaderStageFlags nextStage = 0;
+			if (shader->GetStage() == VK_SHADER_STAGE_VERTEX_BIT && hasFragment)
+			{
+				nextStage = VK_SHADER_STAGE_FRAGMENT_BIT;
+			}
+
+			VkSpecializationInfo specializationInfo{};
+			const auto* specialization = FindSpecialization(shader->GetStage());
+			if (specialization)
+			{
+				specializationInfo = specialization->GetInfo();
+			}
+
+			shaderObjects[std::distance(stages.begin(), it)] = shader->CreateShaderObject(
+				layoutDesc.descriptorSetLayouts,
+				layoutDesc.pushConstantRanges,
+				nextStage,
+				specialization ? &specializationInfo : nullptr
+			);
+			PipelineRegistry::TrackShaderObject(shaderObjects[std::distance(stages.begin(), it)]);
+		}
 
-		return true;
+		return std::make_shared<VulkanPipeline>(shaderObjects, stages, m_PipelineLayout);
 	}
 
 	std::shared_ptr<VulkanPipeline> VulkanPipelineBuilder::BuildCompute()
@@ -141,6 +636,13 @@ namespace tiny_vulkan {
 		stageInfo.module = m_Shaders[0]->GetRaw();
 		stageInfo.pName = "main";
 
+		VkSpecializationInfo specializationInfo{};
+		if (const auto* specialization = FindSpecialization(VK_SHADER_STAGE_COMPUTE_BIT))
+		{
+			specializationInfo = specialization->GetInfo();
+			stageInfo.pSpecializationInfo = &specializationInfo;
+		}
+
 		VkComputePipelineCreateInfo info{};
 		info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
 		info.layout = m_PipelineLayout;
@@ -149,18 +651,37 @@ namespace tiny_vulkan {
 		VkPipeline pipeline{ VK_NULL_HANDLE };
 		CHECK_VK_RES(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &pipeline));
 
-		LifetimeManager::PushFunction(vkDestroyPipeline, device, pipeline, nullptr);
+		PipelineRegistry::TrackPipeline(pipeline);
 
 		return std::make_shared<VulkanPipeline>(pipeline, m_PipelineLayout);
 	}
 
-	std::shared_ptr<VulkanPipeline> VulkanPipelineBuilder::BuildGraphics()
+	// ==============================================================================
+	// Graphics state, shared by the monolithic and the pipeline library paths
+	// ==============================================================================
+	struct VulkanPipelineBuilder::GraphicsStateInfos
+	{
+		std::vector<VkPipelineShaderStageCreateInfo>		preRasterStages;
+		std::vector<VkPipelineShaderStageCreateInfo>		fragmentStages;
+		std::vector<VkSpecializationInfo>					specializationInfos; // Reserved up front, stages point into it
+		VkPipelineRenderingCreateInfo						renderingInfo{};
+		VkPipelineRenderingCreateInfo						viewMaskInfo{}; // Library parts that don't own the attachment formats
+		VkPipelineInputAssemblyStateCreateInfo				assemblyInfo{};
+		VkPipelineRasterizationStateCreateInfo				rasterizerInfo{};
+		VkPipelineDepthStencilStateCreateInfo				depthStencilInfo{};
+		std::vector<VkPipelineColorBlendAttachmentState>	blendAttachments;
+		VkPipelineColorBlendStateCreateInfo					blendInfo{};
+		VkPipelineViewportStateCreateInfo					viewportInfo{};
+		std::vector<VkDynamicState>							dynamicStates;
+		VkPipelineDynamicStateCreateInfo					dynamicInfo{};
+		VkPipelineMultisampleStateCreateInfo				multisampleInfo{};
+		VkPipelineVertexInputStateCreateInfo				vertexInputInfo{};
+	};
+
+	void VulkanPipelineBuilder::FillGraphicsState(GraphicsStateInfos& state) const
 	{
-		auto device = VulkanCore::GetDevice();
-
 		// Shaders
-		std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
-		shaderStages.reserve(m_Shaders.size());
+		state.specializationInfos.reserve(m_Shaders.size());
 		for (const auto& shader : m_Shaders)
 		{
 			VkPipelineShaderStageCreateInfo info{};
@@ -168,129 +689,254 @@ namespace tiny_vulkan {
 			info.module = shader->GetRaw();
 			info.pName = "main";
 			info.stage = shader->GetStage();
-			shaderStages.push_back(info);
+
+			if (const auto* specialization = FindSpecialization(info.stage))
+			{
+				info.pSpecializationInfo = &state.specializationInfos.emplace_back(specialization->GetInfo());
+			}
+
+			if (info.stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+			{
+				state.fragmentStages.push_back(info);
+			}
+			else
+			{
+				state.preRasterStages.push_back(info);
+			}
 		}
 
 		// Rendering
-		VkPipelineRenderingCreateInfo renderingInfo{};
-		renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
-		renderingInfo.colorAttachmentCount = (uint32_t)m_ColorFormats.size();
-		renderingInfo.pColorAttachmentFormats = m_ColorFormats.data();
-		renderingInfo.depthAttachmentFormat = m_DepthFormat;
+		state.renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		state.renderingInfo.colorAttachmentCount = (uint32_t)m_ColorFormats.size();
+		state.renderingInfo.pColorAttachmentFormats = m_ColorFormats.data();
+		state.renderingInfo.depthAttachmentFormat = m_DepthFormat;
+
+		state.viewMaskInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		state.viewMaskInfo.viewMask = state.renderingInfo.viewMask;
+
+		const RasterState raster = MakeRasterState();
 
 		// Input assembly
-		VkPipelineInputAssemblyStateCreateInfo assemblyInfo{};
-		assemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		assemblyInfo.topology = m_Topology;
-		assemblyInfo.primitiveRestartEnable = VK_FALSE;
+		state.assemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		state.assemblyInfo.topology = raster.topology;
+		state.assemblyInfo.primitiveRestartEnable = VK_FALSE;
 
 		// Rasterization 
-		VkPipelineRasterizationStateCreateInfo rasterizerInfo{};
-		rasterizerInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterizerInfo.polygonMode = m_PolygonMode;
-		rasterizerInfo.lineWidth = 1.0f;
-		rasterizerInfo.cullMode = m_CullMode;
-		rasterizerInfo.frontFace = m_FrontFace;
+		state.rasterizerInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		state.rasterizerInfo.polygonMode = raster.polygonMode;
+		state.rasterizerInfo.lineWidth = 1.0f;
+		state.rasterizerInfo.cullMode = raster.cullMode;
+		state.rasterizerInfo.frontFace = raster.frontFace;
 
 		// Depth & Stencil
-		VkPipelineDepthStencilStateCreateInfo depthStencilInfo{};
-		depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		depthStencilInfo.depthTestEnable = m_DepthTestEnable ? VK_TRUE : VK_FALSE;
-		depthStencilInfo.depthWriteEnable = m_DepthTestEnable ? VK_TRUE : VK_FALSE;
-		depthStencilInfo.depthCompareOp = VK_COMPARE_OP_GREATER_OR_EQUAL; 
-		depthStencilInfo.depthBoundsTestEnable = VK_TRUE;
-		depthStencilInfo.stencilTestEnable = VK_FALSE;
-		depthStencilInfo.front = {};
-		depthStencilInfo.back = {};
-		depthStencilInfo.minDepthBounds = 0.0f;
-		depthStencilInfo.maxDepthBounds = 1.0f;
+		state.depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		state.depthStencilInfo.depthTestEnable = raster.depthTestEnable ? VK_TRUE : VK_FALSE;
+		state.depthStencilInfo.depthWriteEnable = raster.depthWriteEnable ? VK_TRUE : VK_FALSE;
+		state.depthStencilInfo.depthCompareOp = raster.depthCompareOp; 
+		state.depthStencilInfo.depthBoundsTestEnable = VK_TRUE;
+		state.depthStencilInfo.stencilTestEnable = VK_FALSE;
+		state.depthStencilInfo.front = {};
+		state.depthStencilInfo.back = {};
+		state.depthStencilInfo.minDepthBounds = 0.0f;
+		state.depthStencilInfo.maxDepthBounds = 1.0f;
 
 		// Color Blending Setup
-		VkPipelineColorBlendAttachmentState blendAttachmentState{};
-		blendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-
-		switch (m_BlendMode)
-		{
-		case BlendMode::ALPHA:
-			blendAttachmentState.blendEnable = VK_TRUE;
-			// formula: color = srcColor * srcAlpha + dstColor * (1 - srcAlpha)
-			blendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-			blendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-			blendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
-			blendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-			blendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-			blendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
-			break;
-
-		case BlendMode::ADDITIVE:
-			blendAttachmentState.blendEnable = VK_TRUE;
-			// formula: color = srcColor * srcAlpha + dstColor * 1
-			blendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-			blendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
-			blendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
-			blendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-			blendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-			blendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
-			break;
-
-		case BlendMode::NONE: 
-		default:
-			blendAttachmentState.blendEnable = VK_FALSE;
-			break;
-		}
-
-		std::vector<VkPipelineColorBlendAttachmentState> blendAttachments(m_ColorFormats.size(), blendAttachmentState);
-
-		VkPipelineColorBlendStateCreateInfo blendInfo{};
-		blendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		blendInfo.attachmentCount = (uint32_t)blendAttachments.size();
-		blendInfo.pAttachments = blendAttachments.data();
-		blendInfo.logicOpEnable = VK_FALSE;
-		blendInfo.logicOp = VK_LOGIC_OP_COPY;
-
-		// Dynamic viewport
-		VkPipelineViewportStateCreateInfo viewportInfo{};
-		viewportInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportInfo.viewportCount = 1;
-		viewportInfo.scissorCount = 1;
-
-		VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-		VkPipelineDynamicStateCreateInfo dynamicInfo{};
-		dynamicInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicInfo.pDynamicStates = dynamicStates;
-		dynamicInfo.dynamicStateCount = 2;
+		state.blendAttachments.assign(m_ColorFormats.size(), DynamicState::GetBlendAttachmentState(raster.blendMode));
+
+		state.blendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		state.blendInfo.attachmentCount = (uint32_t)state.blendAttachments.size();
+		state.blendInfo.pAttachments = state.blendAttachments.data();
+		state.blendInfo.logicOpEnable = VK_FALSE;
+		state.blendInfo.logicOp = VK_LOGIC_OP_COPY;
+
+		// Dynamic viewport (+ the dynamic raster groups, if enabled)
+		state.viewportInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		state.viewportInfo.viewportCount = 1;
+		state.viewportInfo.scissorCount = 1;
+
+		state.dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		auto rasterDynamicStates = DynamicState::GetDynamicStates(ResolveDynamicState());
+		state.dynamicStates.insert(state.dynamicStates.end(), rasterDynamicStates.begin(), rasterDynamicStates.end());
+
+		state.dynamicInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		state.dynamicInfo.pDynamicStates = state.dynamicStates.data();
+		state.dynamicInfo.dynamicStateCount = (uint32_t)state.dynamicStates.size();
 
 		// Multisample 
-		VkPipelineMultisampleStateCreateInfo multisampleInfo{};
-		multisampleInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisampleInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		state.multisampleInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		state.multisampleInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 
 		// Vertex Input 
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		state.vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	}
+
+	std::shared_ptr<VulkanPipeline> VulkanPipelineBuilder::BuildGraphics(const GraphicsPipelineDesc& desc)
+	{
+		GraphicsStateInfos state;
+		FillGraphicsState(state);
+
+		if (m_UsePipelineLibrary && PipelineLibrary::IsSupported())
+		{
+			return BuildGraphicsFromLibraries(desc, state);
+		}
+
+		return BuildGraphicsMonolithic(state);
+	}
+
+	std::shared_ptr<VulkanPipeline> VulkanPipelineBuilder::BuildGraphicsMonolithic(GraphicsStateInfos& state)
+	{
+		auto device = VulkanCore::GetDevice();
+
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages = state.preRasterStages;
+		shaderStages.insert(shaderStages.end(), state.fragmentStages.begin(), state.fragmentStages.end());
 
 		// Build 
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.pNext = &renderingInfo;
+		pipelineInfo.pNext = &state.renderingInfo;
 		pipelineInfo.stageCount = (uint32_t)shaderStages.size();
 		pipelineInfo.pStages = shaderStages.data();
-		pipelineInfo.pVertexInputState = &vertexInputInfo;
-		pipelineInfo.pInputAssemblyState = &assemblyInfo;
-		pipelineInfo.pViewportState = &viewportInfo;
-		pipelineInfo.pRasterizationState = &rasterizerInfo;
-		pipelineInfo.pMultisampleState = &multisampleInfo;
-		pipelineInfo.pDepthStencilState = &depthStencilInfo;
-		pipelineInfo.pColorBlendState = &blendInfo;
-		pipelineInfo.pDynamicState = &dynamicInfo;
+		pipelineInfo.pVertexInputState = &state.vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &state.assemblyInfo;
+		pipelineInfo.pViewportState = &state.viewportInfo;
+		pipelineInfo.pRasterizationState = &state.rasterizerInfo;
+		pipelineInfo.pMultisampleState = &state.multisampleInfo;
+		pipelineInfo.pDepthStencilState = &state.depthStencilInfo;
+		pipelineInfo.pColorBlendState = &state.blendInfo;
+		pipelineInfo.pDynamicState = &state.dynamicInfo;
 		pipelineInfo.layout = m_PipelineLayout;
 
 		VkPipeline pipeline{ VK_NULL_HANDLE };
 		CHECK_VK_RES(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline));
 
-		LifetimeManager::PushFunction(vkDestroyPipeline, device, pipeline, nullptr);
+		PipelineRegistry::TrackPipeline(pipeline);
 
 		return std::make_shared<VulkanPipeline>(pipeline, m_PipelineLayout);
 	}
 
+	std::shared_ptr<VulkanPipeline> VulkanPipelineBuilder::BuildGraphicsFromLibraries(const GraphicsPipelineDesc& desc, GraphicsStateInfos& state)
+	{
+		using PipelineLibrary::LibraryPart;
+
+		PipelineLibrary::LibrarySet libraries{};
+
+		// Every part is keyed only by the state it consumes, so materials that differ
+		// in e.g. blending still share the compiled shader parts.
+		auto hashShaders = [&desc](uint64_t& key, bool fragment)
+			{
+				for (const auto& shader : desc.shaders)
+				{
+					if ((shader.stage == VK_SHADER_STAGE_FRAGMENT_BIT) == fragment)
+					{
+						Hash::Combine(key, shader.hash);
+						Hash::Combine(key, shader.stage);
+						Hash::Combine(key, shader.specialization);
+						Hash::Combine(key, shader.variant);
+					}
+				}
+			};
+
+		// Parts declaring dynamic state are different libraries than their baked counterparts
+		auto hashDynamicState = [&desc](uint64_t& key)
+			{
+				Hash::Combine(key, desc.dynamicState.extended);
+				Hash::Combine(key, desc.dynamicState.blend);
+				Hash::Combine(key, desc.dynamicState.polygonMode);
+			};
+
+		// Vertex input interface
+		{
+			uint64_t key = Hash::FNV_OFFSET_BASIS;
+			Hash::Combine(key, desc.topology);
+			hashDynamicState(key);
+
+			VkGraphicsPipelineCreateInfo info{};
+			info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			info.pVertexInputState = &state.vertexInputInfo;
+			info.pInputAssemblyState = &state.assemblyInfo;
+			info.pDynamicState = &state.dynamicInfo;
+
+			libraries[(size_t)LibraryPart::VERTEX_INPUT] = PipelineLibrary::GetOrCreatePart(LibraryPart::VERTEX_INPUT, key, info);
+		}
+
+		// Pre-rasterization shaders
+		{
+			uint64_t key = desc.layout.GetHash();
+			hashShaders(key, false);
+			Hash::Combine(key, desc.polygonMode);
+			Hash::Combine(key, desc.cullMode);
+			Hash::Combine(key, desc.frontFace);
+			hashDynamicState(key);
+
+			VkGraphicsPipelineCreateInfo info{};
+			info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			info.pNext = &state.viewMaskInfo;
+			info.stageCount = (uint32_t)state.preRasterStages.size();
+			info.pStages = state.preRasterStages.data();
+			info.pViewportState = &state.viewportInfo;
+			info.pRasterizationState = &state.rasterizerInfo;
+			info.pDynamicState = &state.dynamicInfo;
+			info.layout = m_PipelineLayout;
+
+			libraries[(size_t)LibraryPart::PRE_RASTERIZATION] = PipelineLibrary::GetOrCreatePart(LibraryPart::PRE_RASTERIZATION, key, info);
+		}
+
+		// Fragment shader
+		{
+			uint64_t key = desc.layout.GetHash();
+			hashShaders(key, true);
+			Hash::Combine(key, desc.depthTestEnable);
+			Hash::Combine(key, desc.depthWriteEnable);
+			Hash::Combine(key, desc.depthCompareOp);
+			hashDynamicState(key);
+
+			VkGraphicsPipelineCreateInfo info{};
+			info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			info.pNext = &state.viewMaskInfo;
+			info.stageCount = (uint32_t)state.fragmentStages.size();
+			info.pStages = state.fragmentStages.data();
+			info.pDepthStencilState = &state.depthStencilInfo;
+			info.pMultisampleState = &state.multisampleInfo;
+			info.pDynamicState = &state.dynamicInfo;
+			info.layout = m_PipelineLayout;
+
+			libraries[(size_t)LibraryPart::FRAGMENT_SHADER] = PipelineLibrary::GetOrCreatePart(LibraryPart::FRAGMENT_SHADER, key, info);
+		}
+
+		// Fragment output interface
+		{
+			uint64_t key = Hash::FNV_OFFSET_BASIS;
+			for (auto format : desc.colorFormats)
+			{
+				Hash::Combine(key, format);
+			}
+			Hash::Combine(key, desc.depthFormat);
+			Hash::Combine(key, desc.blendMode);
+			hashDynamicState(key);
+
+			VkGraphicsPipelineCreateInfo info{};
+			info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			info.pNext = &state.renderingInfo;
+			info.pColorBlendState = &state.blendInfo;
+			info.pMultisampleState = &state.multisampleInfo;
+			info.pDynamicState = &state.dynamicInfo;
+
+			libraries[(size_t)LibraryPart::FRAGMENT_OUTPUT] = PipelineLibrary::GetOrCreatePart(LibraryPart::FRAGMENT_OUTPUT, key, info);
+		}
+
+		// Fast link now, optionally swap in a link-time optimized pipeline once it is ready
+		VkPipeline pipeline = PipelineLibrary::Link(libraries, m_PipelineLayout, false);
+
+		PipelineRegistry::TrackPipeline(pipeline);
+
+		auto result = std::make_shared<VulkanPipeline>(pipeline, m_PipelineLayout);
+
+		if (m_BackgroundOptimization)
+		{
+			PipelineLibrary::RequestOptimizedLink(result, libraries, m_PipelineLayout);
+		}
+
+		return result;
+	}
+
 }
\ No newline at end of file
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "VulkanShader.h" 
+#include "SpecializationConstants.h"
 
 #include <memory>
 #include <vector>
+#include <unordered_map>
 #include <vulkan/vulkan.h>
 
 namespace tiny_vulkan {
@@ -15,6 +17,13 @@ namespace tiny_vulkan {
 		RAY_TRACING
 	};
 
+	// How the shaders get bound: a baked VkPipeline or VK_EXT_shader_object with all state dynamic.
+	enum class PipelineBackend
+	{
+		PIPELINE,
+		SHADER_OBJECT
+	};
+
 	enum class BlendMode
 	{
 		NONE,       
@@ -22,6 +31,106 @@ namespace tiny_vulkan {
 		ADDITIVE 
 	};
 
+	// ========================================================
+	// Raster & Dynamic State
+	// ========================================================
+	// Fixed-function state that can either be baked into the pipeline or set on the command buffer.
+	struct RasterState
+	{
+		VkPrimitiveTopology		topology{ VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST };
+		VkPolygonMode			polygonMode{ VK_POLYGON_MODE_FILL };
+		VkCullModeFlags			cullMode{ VK_CULL_MODE_BACK_BIT };
+		VkFrontFace				frontFace{ VK_FRONT_FACE_CLOCKWISE };
+		bool					depthTestEnable{ true };
+		bool					depthWriteEnable{ true };
+		VkCompareOp				depthCompareOp{ VK_COMPARE_OP_GREATER_OR_EQUAL };
+		BlendMode				blendMode{ BlendMode::NONE };
+
+		[[nodiscard]] bool operator==(const RasterState& other) const = default;
+	};
+
+	// Which groups of RasterState are dynamic for a pipeline.
+	struct DynamicStateSet
+	{
+		bool extended{ false };		// Vulkan 1.3 core: cull mode, front face, topology, depth test/write/compare
+		bool blend{ false };		// VK_EXT_extended_dynamic_state3: blend enable/equation, color write mask
+		bool polygonMode{ false };	// VK_EXT_extended_dynamic_state3: polygon mode
+
+		[[nodiscard]] bool operator==(const DynamicStateSet& other) const = default;
+		[[nodiscard]] bool Any() const { return extended || blend || polygonMode; }
+	};
+
+	// ========================================================
+	// Pipeline Descriptions (canonical, hashable keys)
+	// ========================================================
+	struct DescriptorSetLayoutDesc
+	{
+		std::vector<VkDescriptorSetLayoutBinding>	bindings;
+
+		[[nodiscard]] bool operator==(const DescriptorSetLayoutDesc& other) const;
+		[[nodiscard]] uint64_t GetHash() const;
+	};
+
+	struct PipelineLayoutDesc
+	{
+		std::vector<VkDescriptorSetLayout>	descriptorSetLayouts;
+		std::vector<VkPushConstantRange>	pushConstantRanges;
+
+		[[nodiscard]] bool operator==(const PipelineLayoutDesc& other) const;
+		[[nodiscard]] uint64_t GetHash() const;
+	};
+
+	struct ShaderIdentity
+	{
+		uint64_t				hash{ 0 };
+		VkShaderStageFlagBits	stage{ VK_SHADER_STAGE_ALL };
+		uint64_t				specialization{ 0 }; // Hash of the stage's specialization constants, 0 if none
+		uint64_t				variant{ 0 };		 // Variant key of the shader's defines, 0 for the default variant
+
+		[[nodiscard]] bool operator==(const ShaderIdentity& other) const = default;
+	};
+
+	struct GraphicsPipelineDesc
+	{
+		PipelineType					type{ PipelineType::GRAPHICS };
+		PipelineBackend					backend{ PipelineBackend::PIPELINE };
+		std::vector<ShaderIdentity>		shaders;
+		PipelineLayoutDesc				layout;
+
+		// Graphics state, left at defaults for compute pipelines so they hash identically
+		std::vector<VkFormat>			colorFormats;
+		VkFormat						depthFormat{ VK_FORMAT_UNDEFINED };
+		VkPrimitiveTopology				topology{ VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST };
+		VkPolygonMode					polygonMode{ VK_POLYGON_MODE_FILL };
+		VkCullModeFlags					cullMode{ VK_CULL_MODE_NONE };
+		VkFrontFace						frontFace{ VK_FRONT_FACE_CLOCKWISE };
+		bool							depthTestEnable{ false };
+		bool							depthWriteEnable{ false };
+		VkCompareOp						depthCompareOp{ VK_COMPARE_OP_NEVER };
+		BlendMode						blendMode{ BlendMode::NONE };
+
+		// State listed here is set on the command buffer and canonicalized out of the fields above
+		DynamicStateSet					dynamicState;
+
+		[[nodiscard]] bool operator==(const GraphicsPipelineDesc& other) const;
+		[[nodiscard]] uint64_t GetHash() const;
+	};
+
+	struct DescriptorSetLayoutDescHasher
+	{
+		size_t operator()(const DescriptorSetLayoutDesc& desc) const { return static_cast<size_t>(desc.GetHash()); }
+	};
+
+	struct PipelineLayoutDescHasher
+	{
+		size_t operator()(const PipelineLayoutDesc& desc) const { return static_cast<size_t>(desc.GetHash()); }
+	};
+
+	struct GraphicsPipelineDescHasher
+	{
+		size_t operator()(const GraphicsPipelineDesc& desc) const { return static_cast<size_t>(desc.GetHash()); }
+	};
+
 	// ========================================================
 	// Vulkan Pipeline 
 	// ========================================================
@@ -31,12 +140,55 @@ namespace tiny_vulkan {
 		explicit VulkanPipeline(VkPipeline pipeline, VkPipelineLayout layout);
 		~VulkanPipeline() = default;
 
-		[[nodiscard]] VkPipeline       GetRaw()    const { return m_Pipeline; }
-		[[nodiscard]] VkPipelineLayout GetLayout() const { return m_PipelineLayout; }
+		// Shader object backend: no VkPipeline, the stages are bound directly.
+		explicit VulkanPipeline(const std::vector<VkShaderEXT>& shaderObjects, const std::vector<VkShaderStageFlagBits>& stages, VkPipelineLayout layout);
+
+		// A view of base with its own dynamic state defaults. Follows handle swaps of base.
+		[[nodiscard]] static std::shared_ptr<VulkanPipeline> CreateDerived(std::shared_ptr<VulkanPipeline> base, const RasterState& defaults);
+
+		[[nodiscard]] VkPipeline       GetRaw()    const { return GetRoot().m_Pipeline; }
+		[[nodiscard]] VkPipelineLayout GetLayout() const { return GetRoot().m_PipelineLayout; }
+
+		[[nodiscard]] const RasterState&		GetRasterState()	const { return m_RasterState; }
+		[[nodiscard]] const DynamicStateSet&	GetDynamicState()	const { return m_DynamicState; }
+		[[nodiscard]] PipelineBackend			GetBackend()		const { return GetRoot().m_Backend; }
+		[[nodiscard]] VkPipelineBindPoint		GetBindPoint()		const { return GetRoot().m_BindPoint; }
+		[[nodiscard]] bool						IsView()			const { return m_Base != nullptr; }
+
+		// Used to swap in a better handle (e.g. a link-time optimized one) at a frame boundary. Returns the previous one.
+		[[nodiscard]] VkPipeline ReplaceRaw(VkPipeline pipeline) { return std::exchange(m_Pipeline, pipeline); }
+
+		/**
+		 * @brief Turns this pipeline into a view of replacement (e.g. rebuilt from edited shaders),
+		 * every holder and derived view follows. The handles owned until now are retired.
+		 * A view passed as replacement is resolved to the pipeline owning its handles.
+		 */
+		void Retarget(std::shared_ptr<VulkanPipeline> replacement);
+		void SetDynamicRasterState(const RasterState& defaults, const DynamicStateSet& dynamicState, uint32_t colorAttachmentCount);
+		void SetBindPoint(VkPipelineBindPoint bindPoint) { m_BindPoint = bindPoint; }
+
+		// Binds the pipeline (or shader objects) and records the builder's defaults for every dynamic state group.
+		void CmdBind(VkCommandBuffer cmdBuffer) const;
+
+		// Viewport/scissor through the command matching the backend (shader objects need the *WithCount variants).
+		void CmdSetViewportAndScissor(VkCommandBuffer cmdBuffer, const VkViewport& viewport, const VkRect2D& scissor) const;
+
+	private:
+		// The pipeline owning the handles: this one, or the end of the chain of views
+		[[nodiscard]] const VulkanPipeline& GetRoot() const { return m_Base ? m_Base->GetRoot() : *this; }
 
 	private:
 		VkPipeline       m_Pipeline{ VK_NULL_HANDLE };
 		VkPipelineLayout m_PipelineLayout{ VK_NULL_HANDLE };
+		RasterState		 m_RasterState;
+		DynamicStateSet	 m_DynamicState;
+		uint32_t		 m_ColorAttachmentCount{ 0 };
+		PipelineBackend	 m_Backend{ PipelineBackend::PIPELINE };
+		VkPipelineBindPoint m_BindPoint{ VK_PIPELINE_BIND_POINT_GRAPHICS };
+
+		std::vector<VkShaderEXT>			m_ShaderObjects;
+		std::vector<VkShaderStageFlagBits>	m_ShaderStages;
+		std::shared_ptr<VulkanPipeline>		m_Base;
 	};
 
 	// ========================================================
@@ -48,13 +200,22 @@ namespace tiny_vulkan {
 		VulkanPipelineBuilder() = default;
 
 		[[nodiscard]] VulkanPipelineBuilder& SetPipelineType(PipelineType type);
+		[[nodiscard]] VulkanPipelineBuilder& SetBackend(PipelineBackend backend);
 
 		// Layout Setup
 		[[nodiscard]] VulkanPipelineBuilder& AddDescriptorLayout(VkDescriptorSetLayout layout);
 		[[nodiscard]] VulkanPipelineBuilder& AddPushConstantRange(VkPushConstantRange range);
 
+		// Derive set layouts/push constant ranges from the shaders' SPIR-V when none were added by hand (on by default).
+		[[nodiscard]] VulkanPipelineBuilder& UseReflection(bool enable);
+
 		// Shader Stages
 		[[nodiscard]] VulkanPipelineBuilder& AddShader(std::shared_ptr<VulkanShader> shader);
+		[[nodiscard]] VulkanPipelineBuilder& SetSpecializationConstants(VkShaderStageFlagBits stage, const SpecializationConstants& constants);
+
+		// Swaps every stage, keeping the rest of the description (e.g. shaders recompiled by the hot reload).
+		[[nodiscard]] VulkanPipelineBuilder& ReplaceShaders(std::vector<std::shared_ptr<VulkanShader>> shaders);
+		[[nodiscard]] const std::vector<std::shared_ptr<VulkanShader>>& GetShaders() const { return m_Shaders; }
 
 		// Graphics Configuration
 		[[nodiscard]] VulkanPipelineBuilder& SetColorAttachmentFormats(const std::vector<VkFormat>& formats);
@@ -66,23 +227,49 @@ namespace tiny_vulkan {
 
 		// Depth & Blend Configuration
 		[[nodiscard]] VulkanPipelineBuilder& EnableDepthTest(bool enable);
+		[[nodiscard]] VulkanPipelineBuilder& EnableDepthWrite(bool enable);
+		[[nodiscard]] VulkanPipelineBuilder& SetDepthCompareOp(VkCompareOp compareOp);
 		[[nodiscard]] VulkanPipelineBuilder& SetBlendMode(BlendMode mode);
 
-		// Build
+		// Moves cull/front face/topology/depth (and blend/polygon mode when supported) to command buffer state,
+		// so pipelines differing only in that state collapse into one.
+		[[nodiscard]] VulkanPipelineBuilder& EnableDynamicState(bool enable);
+
+		// Compilation (VK_EXT_graphics_pipeline_library, falls back to monolithic when unsupported)
+		[[nodiscard]] VulkanPipelineBuilder& UsePipelineLibrary(bool enable);
+		[[nodiscard]] VulkanPipelineBuilder& EnableBackgroundOptimization(bool enable);
+
+		// Build (returns the already registered pipeline when an identical one exists)
 		[[nodiscard]] std::shared_ptr<VulkanPipeline> Build();
+		[[nodiscard]] GraphicsPipelineDesc MakeDesc() const;
 
 	private:
-		[[nodiscard]] bool BuildPipelineLayout();
+		struct GraphicsStateInfos;
+
+		// Layouts added by hand, completed from reflection: the builder itself is left as configured
+		[[nodiscard]] PipelineLayoutDesc ResolveLayout() const;
+		[[nodiscard]] bool BuildPipelineLayout(const PipelineLayoutDesc& layoutDesc);
 		[[nodiscard]] std::shared_ptr<VulkanPipeline> BuildCompute();
-		[[nodiscard]] std::shared_ptr<VulkanPipeline> BuildGraphics();
+		[[nodiscard]] std::shared_ptr<VulkanPipeline> BuildShaderObjects(const PipelineLayoutDesc& layoutDesc);
+		[[nodiscard]] PipelineBackend ResolveBackend() const;
+		[[nodiscard]] std::shared_ptr<VulkanPipeline> BuildGraphics(const GraphicsPipelineDesc& desc);
+		[[nodiscard]] std::shared_ptr<VulkanPipeline> BuildGraphicsMonolithic(GraphicsStateInfos& state);
+		[[nodiscard]] std::shared_ptr<VulkanPipeline> BuildGraphicsFromLibraries(const GraphicsPipelineDesc& desc, GraphicsStateInfos& state);
+		void FillGraphicsState(GraphicsStateInfos& state) const;
+		[[nodiscard]] RasterState MakeRasterState() const;
+		[[nodiscard]] DynamicStateSet ResolveDynamicState() const;
+		[[nodiscard]] const SpecializationConstants* FindSpecialization(VkShaderStageFlagBits stage) const;
 
 	private:
 		PipelineType									m_Type{ PipelineType::GRAPHICS };
+		PipelineBackend									m_Backend{ PipelineBackend::PIPELINE };
 		VkPipelineLayout								m_PipelineLayout{ VK_NULL_HANDLE };
 
 		std::vector<std::shared_ptr<VulkanShader>>		m_Shaders;
+		std::unordered_map<VkShaderStageFlagBits, SpecializationConstants> m_Specializations;
 		std::vector<VkDescriptorSetLayout>				m_DescriptorSetLayouts;
 		std::vector<VkPushConstantRange>				m_Ranges;
+		bool											m_UseReflection{ true };
 
 		// Graphics State
 		std::vector<VkFormat>							m_ColorFormats;
@@ -95,7 +282,13 @@ namespace tiny_vulkan {
 		// Depth & Blend State
 		bool											m_DepthTestEnable{ true };
 		bool											m_DepthWriteEnable{ true };
+		VkCompareOp										m_DepthCompareOp{ VK_COMPARE_OP_GREATER_OR_EQUAL };
 		BlendMode										m_BlendMode{ BlendMode::NONE };
+		bool											m_DynamicState{ false };
+
+		// Compilation
+		bool											m_UsePipelineLibrary{ true };
+		bool											m_BackgroundOptimization{ true };
 	};
 
 }
\ No newline at end of file
@@ -1,11 +1,12 @@
 #include "VulkanShader.h"
 #include "VulkanCore.h"
+#include "VulkanExtensions.h"
 #include "Filesystem.h"
-#include "LifetimeManager.h"
+#include "ShaderCompiler.h"
+#include "Hash.h"
+#include "DeletionQueue.h"
 #include "LogSystem.h"
 
-#include <shaderc/shaderc.hpp>
-
 namespace tiny_vulkan {
 
 	// ==============================================================================
@@ -13,19 +14,30 @@ namespace tiny_vulkan {
 	// ==============================================================================
 	namespace {
 
-		shaderc_shader_kind GetShadercKind(const std::filesystem::path& path)
+#ifdef TINY_SHADER_BIN_DIR
+		// SPIR-V precompiled at build time, deployed next to the executable (TINY_SHADER_BIN_DIR is relative to it).
+		const std::filesystem::path& GetPrebuiltDir()
 		{
-			auto ext = path.extension().string();
-			if (ext == ".vert") return shaderc_vertex_shader;
-			if (ext == ".frag") return shaderc_fragment_shader;
-			if (ext == ".comp") return shaderc_compute_shader;
-			if (ext == ".geom") return shaderc_geometry_shader;
-			if (ext == ".tesc") return shaderc_tess_control_shader;
-			if (ext == ".tese") return shaderc_tess_evaluation_shader;
-			if (ext == ".mesh") return shaderc_mesh_shader;
-			if (ext == ".task") return shaderc_task_shader;
-			return shaderc_glsl_infer_from_source;
+			static const std::filesystem::path dir = IO::GetExecutableDirectory() / TINY_SHADER_BIN_DIR;
+			return dir;
+		}
+
+		// Manifest of the SPIR-V precompiled at build time, read once.
+		const ShaderCompiler::Manifest& GetPrebuiltManifest()
+		{
+			static const ShaderCompiler::Manifest manifest = []()
+				{
+					ShaderCompiler::Manifest result;
+					const auto manifestPath = GetPrebuiltDir() / ShaderCompiler::MANIFEST_NAME;
+					if (!ShaderCompiler::ReadManifest(manifestPath, result))
+					{
+						LOG_WARN(fmt::runtime("No prebuilt shader manifest at {}, compiling at runtime"), manifestPath.string());
+					}
+					return result;
+				}();
+			return manifest;
 		}
+#endif
 
 		VkShaderStageFlagBits GetVkShaderStage(const std::filesystem::path& path)
 		{
@@ -45,43 +57,118 @@ namespace tiny_vulkan {
 	// ==============================================================================
 	// VulkanShader Implementation
 	// ==============================================================================
-	VulkanShader::VulkanShader(const std::filesystem::path& path)
-		: m_ShaderPath(path)
+	VulkanShader::VulkanShader(const std::filesystem::path& path, const ShaderCompiler::Defines& defines)
+		: m_Stage(GetVkShaderStage(path))
+		, m_ShaderPath(path)
+		, m_VariantKey(ShaderCompiler::GetVariantKey(defines))
+		, m_Defines(defines)
 	{
-		auto device = VulkanCore::GetDevice();
+		if (!LoadSPIRV(m_ShaderPath, defines, m_SPIRV, m_Dependencies))
+		{
+			return;
+		}
+
+		CreateModule();
+	}
 
-		if (!std::filesystem::exists(m_ShaderPath))
+	VulkanShader::VulkanShader(const std::filesystem::path& path, std::vector<uint32_t> spirv, uint64_t variantKey)
+		: m_Stage(GetVkShaderStage(path))
+		, m_ShaderPath(path)
+		, m_SPIRV(std::move(spirv))
+		, m_VariantKey(variantKey)
+	{
+		if (m_SPIRV.empty())
 		{
-			LOG_ERROR(fmt::runtime("Shader file not found: {}"), m_ShaderPath.string());
+			LOG_ERROR(fmt::runtime("Spirv is empty for: {}"), m_ShaderPath.string());
 			return;
 		}
 
-		m_Stage = GetVkShaderStage(m_ShaderPath);
-		auto cachePath = GetCachedPath(m_ShaderPath);
+		CreateModule();
+	}
 
-		// Try to load a cache( .spv ).
-		if (CheckCacheValidity(m_ShaderPath, cachePath))
+	VulkanShader::~VulkanShader()
+	{
+		// Released at a frame boundary, like every other resource retired while running
+		if (m_ShaderModule != VK_NULL_HANDLE)
 		{
-			LOG_DEBUG(fmt::runtime("Cache is present, loading: {}"), cachePath.filename().string());
-			LoadFromCache(cachePath, m_SPIRV);
+			DeletionQueue::PushFunction(vkDestroyShaderModule, VulkanCore::GetDevice(), m_ShaderModule, nullptr);
 		}
-		else
+	}
+
+	std::vector<std::shared_ptr<VulkanShader>> VulkanShader::CompileBatch(const std::vector<std::filesystem::path>& paths)
+	{
+		std::vector<ShaderVariantDesc> variants;
+		variants.reserve(paths.size());
+		for (const auto& path : paths)
 		{
-			// Compile.
-			if (!CompileToSPIRV(m_ShaderPath, m_SPIRV))
+			variants.push_back(ShaderVariantDesc{ .path = path });
+		}
+		return CompileBatch(variants);
+	}
+
+	std::vector<std::shared_ptr<VulkanShader>> VulkanShader::CompileBatch(const std::vector<ShaderVariantDesc>& variants)
+	{
+		const auto batchStart = std::chrono::steady_clock::now();
+
+		std::vector<std::vector<uint32_t>> spirvs(variants.size());
+		std::vector<std::vector<std::filesystem::path>> dependencies(variants.size());
+		std::atomic<size_t> nextIndex{ 0 };
+
+		auto worker = [&]()
 			{
-				LOG_ERROR(fmt::runtime("Failed to compile shader: {}"), m_ShaderPath.string());
-			}
-			else
+				for (size_t i = nextIndex++; i < variants.size(); i = nextIndex++)
+				{
+					if (!LoadSPIRV(variants[i].path, variants[i].defines, spirvs[i], dependencies[i]))
+					{
+						spirvs[i].clear();
+					}
+				}
+			};
+
+		const size_t workerCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), variants.size());
+		{
+			std::vector<std::jthread> workers;
+			workers.reserve(workerCount);
+			for (size_t i = 0; i < workerCount; ++i)
 			{
-				LOG_DEBUG(fmt::runtime("Shader {} compiled!"), m_ShaderPath.filename().string());
+				workers.emplace_back(worker);
 			}
-			SaveToCache(cachePath, m_SPIRV);
+		} // joined here
+
+		// Modules are created on the calling thread, after every worker is done
+		std::vector<std::shared_ptr<VulkanShader>> shaders;
+		shaders.reserve(variants.size());
+		for (size_t i = 0; i < variants.size(); ++i)
+		{
+			shaders.push_back(CreateFromSPIRV(variants[i], std::move(spirvs[i]), std::move(dependencies[i])));
 		}
 
-		if (m_SPIRV.empty())
+		const auto batchTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - batchStart);
+		LOG_INFO(fmt::runtime("Shader batch: {0} shaders on {1} threads in {2} ms"), variants.size(), workerCount, batchTime.count());
+
+		return shaders;
+	}
+
+	std::shared_ptr<VulkanShader> VulkanShader::CreateFromSPIRV(
+		const ShaderVariantDesc&				variant,
+		std::vector<uint32_t>					spirv,
+		std::vector<std::filesystem::path>		dependencies)
+	{
+		auto shader = std::make_shared<VulkanShader>(variant.path, std::move(spirv), ShaderCompiler::GetVariantKey(variant.defines));
+		shader->m_Defines = variant.defines;
+		shader->m_Dependencies = std::move(dependencies);
+		return shader;
+	}
+
+	void VulkanShader::CreateModule()
+	{
+		auto device = VulkanCore::GetDevice();
+
+		m_Hash = Hash::Bytes(m_SPIRV.data(), m_SPIRV.size() * sizeof(uint32_t));
+
+		if (!Reflection::Reflect(m_SPIRV, m_Stage, m_Reflection))
 		{
-			LOG_ERROR(fmt::runtime("Spirv is empty for: {}"), m_ShaderPath.string());
+			LOG_WARN(fmt::runtime("Failed to reflect shader: {}"), m_ShaderPath.string());
 		}
 
 		// Create shader module.
@@ -91,8 +178,94 @@ namespace tiny_vulkan {
 		createInfo.pCode = m_SPIRV.data();
 
 		CHECK_VK_RES(vkCreateShaderModule(device, &createInfo, nullptr, &m_ShaderModule));
+	}
+
+	bool VulkanShader::LoadSPIRV(
+		const std::filesystem::path&			path,
+		const ShaderCompiler::Defines&			defines,
+		std::vector<uint32_t>&					outSpirv,
+		std::vector<std::filesystem::path>&		outDependencies)
+	{
+		if (!std::filesystem::exists(path))
+		{
+			LOG_ERROR(fmt::runtime("Shader file not found: {}"), path.string());
+			return false;
+		}
+
+		auto rawSource = IO::ReadFile(path);
+		if (!rawSource)
+		{
+			return false;
+		}
+
+		// Binary precompiled at build time (default variant only), no shaderc involved
+		if (defines.empty() && LoadPrebuilt(path, *rawSource, outSpirv, outDependencies))
+		{
+			LOG_DEBUG(fmt::runtime("Prebuilt shader loaded: {}"), path.filename().string());
+			return true;
+		}
 
-		LifetimeManager::PushFunction(vkDestroyShaderModule, device, m_ShaderModule, nullptr);
+		std::string source;
+		std::string error;
+		if (!ShaderCompiler::Preprocess(path, *rawSource, defines, source, outDependencies, error))
+		{
+			LOG_ERROR(fmt::runtime("Shader preprocessing failed ({}):\n{}"), path.string(), error);
+			return false;
+		}
+
+		auto cachePath = GetCachedPath(path, ShaderCompiler::ComputeCacheKey(path, source));
+
+		// Try to load a cache( .spv ).
+		if (LoadFromCache(cachePath, outSpirv))
+		{
+			LOG_DEBUG(fmt::runtime("Cache is present, loading: {}"), cachePath.filename().string());
+			return true;
+		}
+
+		// Compile.
+		if (!ShaderCompiler::Compile(path, source, outSpirv, error))
+		{
+			LOG_ERROR(fmt::runtime("Shader compilation failed ({}):\n{}"), path.string(), error);
+			return false;
+		}
+
+		if (outSpirv.empty())
+		{
+			LOG_ERROR(fmt::runtime("Spirv is empty for: {}"), path.string());
+			return false;
+		}
+
+		LOG_DEBUG(fmt::runtime("Shader {} compiled!"), path.filename().string());
+		SaveToCache(cachePath, outSpirv);
+		return true;
+	}
+
+	VkShaderEXT VulkanShader::CreateShaderObject(
+		const std::vector<VkDescriptorSetLayout>&	setLayouts,
+		const std::vector<VkPushConstantRange>&		pushConstantRanges,
+		VkShaderStageFlags							nextStage,
+		const VkSpecializationInfo*					specialization) const
+	{
+		auto device = VulkanCore::GetDevice();
+
+		VkShaderCreateInfoEXT createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+		createInfo.stage = m_Stage;
+		createInfo.nextStage = nextStage;
+		createInfo.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+		createInfo.codeSize = m_SPIRV.size() * sizeof(uint32_t);
+		createInfo.pCode = m_SPIRV.data();
+		createInfo.pName = "main";
+		createInfo.setLayoutCount = (uint32_t)setLayouts.size();
+		createInfo.pSetLayouts = setLayouts.data();
+		createInfo.pushConstantRangeCount = (uint32_t)pushConstantRanges.size();
+		createInfo.pPushConstantRanges = pushConstantRanges.data();
+		createInfo.pSpecializationInfo = specialization;
+
+		VkShaderEXT shaderObject{ VK_NULL_HANDLE };
+		CHECK_VK_RES(Extensions::CreateShadersEXT(device, 1, &createInfo, nullptr, &shaderObject));
+
+		return shaderObject;
 	}
 
 	// ==============================================================================
@@ -108,60 +281,112 @@ namespace tiny_vulkan {
 		return path;
 	}
 
-	std::filesystem::path VulkanShader::GetCachedPath(const std::filesystem::path& sourcePath)
+	std::filesystem::path VulkanShader::GetCachedPath(const std::filesystem::path& sourcePath, uint64_t cacheKey)
 	{
-		return GetCacheDir() / (sourcePath.stem().string() + ".spv");
+		return GetCacheDir() / ShaderCompiler::GetBinaryName(sourcePath, cacheKey);
 	}
 
-	bool VulkanShader::CheckCacheValidity(const std::filesystem::path& sourcePath, const std::filesystem::path& cachePath)
+	bool VulkanShader::LoadPrebuilt(
+		const std::filesystem::path&			path,
+		const std::string&						rawSource,
+		std::vector<uint32_t>&					outSpirv,
+		std::vector<std::filesystem::path>&		outDependencies)
 	{
-		if (!std::filesystem::exists(cachePath)) return false;
-		auto sourceTime = std::filesystem::last_write_time(sourcePath);
-		auto cacheTime = std::filesystem::last_write_time(cachePath);
-		return cacheTime > sourceTime;
-	}
+#ifdef TINY_SHADER_BIN_DIR
+		const auto& manifest = GetPrebuiltManifest();
 
-	bool VulkanShader::CompileToSPIRV(const std::filesystem::path& path, std::vector<uint32_t>& outSpirv)
-	{
-		auto glslSource = IO::ReadFile(path).value();
+		auto it = manifest.find(path.filename().string());
+		if (it == manifest.end())
+		{
+			return false;
+		}
 
-		shaderc::Compiler compiler;
-		shaderc::CompileOptions options;
+		// Edited since the build, fall back to the runtime compiler
+		if (it->second.sourceHash != Hash::String(rawSource))
+		{
+			LOG_DEBUG(fmt::runtime("Prebuilt shader is stale: {}"), path.filename().string());
+			return false;
+		}
 
-		options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
-		options.SetOptimizationLevel(shaderc_optimization_level_performance);
+		// Same for every included file, resolved next to this shader like a runtime compile would
+		std::vector<std::filesystem::path> dependencies;
+		for (const auto& dependency : it->second.dependencies)
+		{
+			const auto dependencyPath = ShaderCompiler::CanonicalPath(path.parent_path() / dependency.path);
 
-		shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(
-			glslSource.c_str(),
-			glslSource.size(),
-			GetShadercKind(path),
-			path.string().c_str(),
-			"main",
-			options
-		);
+			std::error_code ec;
+			auto content = std::filesystem::exists(dependencyPath, ec) ? IO::ReadFile(dependencyPath) : std::nullopt;
+			if (!content || Hash::String(*content) != dependency.hash)
+			{
+				LOG_DEBUG(fmt::runtime("Prebuilt shader {0} is stale, {1} changed"), path.filename().string(), dependencyPath.string());
+				return false;
+			}
+			dependencies.push_back(dependencyPath);
+		}
 
-		if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+		auto spirv = IO::ReadFileBin(GetPrebuiltDir() / it->second.binaryName);
+		if (!spirv || !ShaderCompiler::IsValidSPIRV(*spirv))
 		{
-			LOG_ERROR(fmt::runtime("Shader compilation failed ({}):\n{}"), path.string(), result.GetErrorMessage());
 			return false;
 		}
 
-		outSpirv.assign(result.begin(), result.end());
+		outSpirv = std::move(*spirv);
+
+		outDependencies = std::move(dependencies);
 		return true;
+#else
+		return false;
+#endif
 	}
 
-	void VulkanShader::LoadFromCache(const std::filesystem::path& cachePath, std::vector<uint32_t>& outSpirv)
+	bool VulkanShader::LoadFromCache(const std::filesystem::path& cachePath, std::vector<uint32_t>& outSpirv)
 	{
-		outSpirv = std::move(IO::ReadFileBin(cachePath).value());
+		if (!std::filesystem::exists(cachePath))
+		{
+			return false;
+		}
+
+		auto spirv = IO::ReadFileBin(cachePath);
+		if (!spirv || !ShaderCompiler::IsValidSPIRV(*spirv))
+		{
+			LOG_WARN(fmt::runtime("Discarding corrupt shader cache entry: {}"), cachePath.filename().string());
+			return false;
+		}
+
+		outSpirv = std::move(*spirv);
+		return true;
 	}
 
 	void VulkanShader::SaveToCache(const std::filesystem::path& cachePath, const std::vector<uint32_t>& spirv)
 	{
-		std::ofstream file(cachePath, std::ios::binary);
-		if (file.is_open())
+		// Write a private temp file and rename it over the entry, so a concurrent
+		// reader (another process or thread) never sees a partially written file.
+		auto tempPath = cachePath;
+		tempPath += fmt::format(".{0:x}.tmp", std::random_device{}());
+
 		{
+			std::ofstream file(tempPath, std::ios::binary);
+			if (!file.is_open())
+			{
+				return;
+			}
 			file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+			if (!file)
+			{
+				file.close();
+				std::error_code ec;
+				std::filesystem::remove(tempPath, ec);
+				return;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, cachePath, ec);
+		if (ec)
+		{
+			// Someone else published the same entry first, the content is identical
+			std::filesystem::remove(tempPath, ec);
 		}
 	}
 
-}
\ No newline at end of file
+}
@@ -1,28 +1,94 @@
 #pragma once
 
+#include "ShaderReflection.h"
+#include "ShaderCompiler.h"
+
 #include <vector>
+#include <string>
+#include <memory>
 #include <filesystem>
 #include <vulkan/vulkan.h>
 
 namespace tiny_vulkan {
 
+	// A shader source plus the preprocessor defines selecting one of its variants.
+	struct ShaderVariantDesc
+	{
+		std::filesystem::path		path;
+		ShaderCompiler::Defines		defines;
+	};
+
 	class VulkanShader
 	{
 	public:
-		VulkanShader(const std::filesystem::path& path);
-		~VulkanShader() = default;
+		VulkanShader(const std::filesystem::path& path, const ShaderCompiler::Defines& defines = {});
+		// From already compiled SPIR-V, path only identifies the stage and is kept for logging.
+		VulkanShader(const std::filesystem::path& path, std::vector<uint32_t> spirv, uint64_t variantKey = 0);
+		~VulkanShader(); // The module goes through the deletion queue
+
+		VulkanShader(const VulkanShader&) = delete;
+		VulkanShader& operator=(const VulkanShader&) = delete;
+
+		/**
+		 * @brief Compiles the cache misses of paths concurrently, one shaderc compiler per worker thread,
+		 * then creates the modules on the calling thread. Results are in the order of paths.
+		 */
+		[[nodiscard]] static std::vector<std::shared_ptr<VulkanShader>> CompileBatch(const std::vector<std::filesystem::path>& paths);
+		[[nodiscard]] static std::vector<std::shared_ptr<VulkanShader>> CompileBatch(const std::vector<ShaderVariantDesc>& variants);
+
+		// Module from SPIR-V produced by LoadSPIRV (e.g. on a worker thread). Must be called on the render thread.
+		[[nodiscard]] static std::shared_ptr<VulkanShader> CreateFromSPIRV(
+			const ShaderVariantDesc&				variant,
+			std::vector<uint32_t>					spirv,
+			std::vector<std::filesystem::path>		dependencies
+		);
+
+		// Cache lookup, compilation on a miss and cache store. Safe to call from any thread.
+		[[nodiscard]] static bool LoadSPIRV(
+			const std::filesystem::path&			path,
+			const ShaderCompiler::Defines&			defines,
+			std::vector<uint32_t>&					outSpirv,
+			std::vector<std::filesystem::path>&		outDependencies
+		);
 
 		[[nodiscard]] VkShaderModule				GetRaw()	const { return m_ShaderModule; }
 		[[nodiscard]] VkShaderStageFlagBits			GetStage()	const { return m_Stage; }
 		[[nodiscard]] const std::vector<uint32_t>&  GetCode()	const { return m_SPIRV; }
+		[[nodiscard]] uint64_t						GetHash()	const { return m_Hash; } // Identity of the SPIR-V, used in pipeline keys
+		[[nodiscard]] const ShaderReflection&		GetReflection()	const { return m_Reflection; }
+		[[nodiscard]] uint64_t						GetVariantKey()	const { return m_VariantKey; } // ShaderCompiler::GetVariantKey of the defines
+		[[nodiscard]] const std::filesystem::path&	GetPath()		const { return m_ShaderPath; }
+		[[nodiscard]] ShaderVariantDesc				GetVariant()	const { return ShaderVariantDesc{ .path = m_ShaderPath, .defines = m_Defines }; }
+
+		// Files #included by the source (transitively). Editing any of them invalidates this shader.
+		[[nodiscard]] const std::vector<std::filesystem::path>& GetDependencies() const { return m_Dependencies; }
+
+		/**
+		 * @brief Creates a VK_EXT_shader_object handle from the same SPIR-V.
+		 * setLayouts/pushConstantRanges must match the layout used for binding resources,
+		 * nextStage lists the stages allowed to follow this one. The caller owns the handle.
+		 */
+		[[nodiscard]] VkShaderEXT CreateShaderObject(
+			const std::vector<VkDescriptorSetLayout>&	setLayouts,
+			const std::vector<VkPushConstantRange>&		pushConstantRanges,
+			VkShaderStageFlags							nextStage,
+			const VkSpecializationInfo*					specialization = nullptr) const;
 
 	private:
+		void CreateModule();
+
 		[[nodiscard]]  static std::filesystem::path GetCacheDir();
-		[[nodiscard]]  static std::filesystem::path GetCachedPath(const std::filesystem::path& sourcePath);
-		[[nodiscard]]  static bool CheckCacheValidity(const std::filesystem::path& sourcePath, const std::filesystem::path& cachePath);
+		[[nodiscard]]  static std::filesystem::path GetCachedPath(const std::filesystem::path& sourcePath, uint64_t cacheKey);
+
+		// SPIR-V precompiled by the build (TINY_SHADER_BIN_DIR), used only while rawSource matches the manifest.
+		[[nodiscard]]  static bool LoadPrebuilt(
+			const std::filesystem::path&			path,
+			const std::string&						rawSource,
+			std::vector<uint32_t>&					outSpirv,
+			std::vector<std::filesystem::path>&		outDependencies
+		);
 
-		[[nodiscard]]  static bool CompileToSPIRV(const std::filesystem::path& path, std::vector<uint32_t>& outSpirv);
-		static void LoadFromCache(const std::filesystem::path& cachePath, std::vector<uint32_t>& outSpirv);
+		[[nodiscard]]  static bool LoadFromCache(const std::filesystem::path& cachePath, std::vector<uint32_t>& outSpirv);
 		static void SaveToCache(const std::filesystem::path& cachePath, const std::vector<uint32_t>& spirv);
 
 	private:
@@ -30,6 +96,11 @@ namespace tiny_vulkan {
 		VkShaderStageFlagBits	m_Stage{ VK_SHADER_STAGE_ALL };
 		std::filesystem::path	m_ShaderPath;
 		std::vector<uint32_t>	m_SPIRV;
+		uint64_t				m_Hash{ 0 };
+		uint64_t				m_VariantKey{ 0 };
+		ShaderCompiler::Defines	m_Defines;
+		ShaderReflection		m_Reflection;
+		std::vector<std::filesystem::path> m_Dependencies;
 	};
 
 }
\ No newline at end of file
@@ -118,26 +118,24 @@ namespace tiny_vulkan {
 		ImGui::Render();
 	}
 
-	void ImGuiRenderer::DrawImGui(std::shared_ptr<VulkanImage> swapchainImage)
+	void ImGuiRenderer::DrawImGui(VkCommandBuffer cmdBuffer, const VulkanImage& target)
 	{
-		auto cmdBuffer = VulkanCore::GetCurrentFrame()->GetCmdBuffer();
-
 		Render();
 
 		VkRenderingAttachmentInfo attachmentInfo = {};
 		attachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
 		attachmentInfo.pNext = nullptr;
-		attachmentInfo.imageView = swapchainImage->GetView();
+		attachmentInfo.imageView = target.GetView();
 		attachmentInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		attachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
 		attachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 
-		VkExtent3D swapchainImageExtent = swapchainImage->GetExtent();
+		VkExtent3D targetExtent = target.GetExtent();
 		VkRenderingInfo renderingInfo = {};
 		renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
 		renderingInfo.pNext = nullptr;
 		renderingInfo.flags = 0;
-		renderingInfo.renderArea = VkRect2D{ {0,0}, {swapchainImageExtent.width, swapchainImageExtent.height} };
+		renderingInfo.renderArea = VkRect2D{ {0,0}, {targetExtent.width, targetExtent.height} };
 		renderingInfo.layerCount = 1;
 		renderingInfo.viewMask = 0;
 		renderingInfo.colorAttachmentCount = 1;
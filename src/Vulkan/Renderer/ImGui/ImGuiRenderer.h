@@ -14,7 +14,8 @@ namespace tiny_vulkan {
 		ImGuiRenderer(std::shared_ptr<Window> window);
 		~ImGuiRenderer() = default;
 
-		void DrawImGui(std::shared_ptr<VulkanImage> swapchainImage);
+		// Records the UI on top of target, which the caller transitioned to COLOR_ATTACHMENT_OPTIMAL.
+		void DrawImGui(VkCommandBuffer cmdBuffer, const VulkanImage& target);
 
 	private:
 		void Render();
@@ -0,0 +1,480 @@
+#include "RenderGraph.h"
+#include "VulkanCore.h"
+#include "DeletionQueue.h"
+#include "LogSystem.h"
+#include "Hash.h"
+
+namespace tiny_vulkan {
+
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		struct UsageInfo
+		{
+			VkPipelineStageFlags2	stage;
+			VkAccessFlags2			access;
+			VkImageLayout			layout;
+			VkImageUsageFlags		imageUsage;
+		};
+
+		UsageInfo GetUsageInfo(ImageUsage usage)
+		{
+			switch (usage)
+			{
+			case ImageUsage::COLOR_ATTACHMENT:
+				return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+					VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+					VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+			case ImageUsage::DEPTH_ATTACHMENT:
+				return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+					VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+					VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT };
+			case ImageUsage::TRANSFER_SRC:
+				return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+					VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+			case ImageUsage::TRANSFER_DST:
+				return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT };
+			case ImageUsage::SAMPLED:
+				return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+					VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT };
+			case ImageUsage::STORAGE_READ:
+				return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+					VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT };
+			case ImageUsage::STORAGE_WRITE:
+				return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+					VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT };
+			case ImageUsage::PRESENT:
+				// Presentation waits on the submit semaphore, only the layout matters
+				return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 0 };
+			}
+			return { VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, 0 };
+		}
+
+		VkImageAspectFlags GetAspect(VkFormat format)
+		{
+			switch (format)
+			{
+			case VK_FORMAT_D16_UNORM:
+			case VK_FORMAT_X8_D24_UNORM_PACK32:
+			case VK_FORMAT_D32_SFLOAT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT;
+			case VK_FORMAT_D16_UNORM_S8_UINT:
+			case VK_FORMAT_D24_UNORM_S8_UINT:
+			case VK_FORMAT_D32_SFLOAT_S8_UINT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+			case VK_FORMAT_S8_UINT:
+				return VK_IMAGE_ASPECT_STENCIL_BIT;
+			default:
+				return VK_IMAGE_ASPECT_COLOR_BIT;
+			}
+		}
+
+		VkImageCreateInfo MakeImageInfo(const TransientImageDesc& desc, VkImageUsageFlags usage)
+		{
+			VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.format = desc.format;
+			imageInfo.extent = desc.extent;
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.usage = usage;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			return imageInfo;
+		}
+	}
+
+	// ========================================================
+	// PassBuilder
+	// ========================================================
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(RenderGraphResource resource, ImageUsage usage)
+	{
+		return Access(resource, usage, false);
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(RenderGraphResource resource, ImageUsage usage)
+	{
+		return Access(resource, usage, true);
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::SetSideEffect()
+	{
+		m_Graph.m_Passes[m_PassIndex].sideEffect = true;
+		return *this;
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::Access(RenderGraphResource resource, ImageUsage usage, bool write)
+	{
+		auto& pass = m_Graph.m_Passes[m_PassIndex];
+		if (!resource.IsValid() || resource.index >= m_Graph.m_Resources.size())
+		{
+			LOG_ERROR(fmt::runtime("Render pass {0} uses an invalid resource"), pass.name);
+			return *this;
+		}
+
+		// One barrier per image and pass: a second declaration may only widen the same usage to a write
+		for (auto& access : pass.accesses)
+		{
+			if (access.resource != resource.index)
+			{
+				continue;
+			}
+
+			if (access.usage != usage)
+			{
+				LOG_ERROR(fmt::runtime("Render pass {0} uses {1} with two different usages"), pass.name, m_Graph.m_Resources[resource.index].name);
+				return *this;
+			}
+			access.write |= write;
+			return *this;
+		}
+
+		pass.accesses.push_back(ResourceAccess{ .resource = resource.index, .usage = usage, .write = write });
+		m_Graph.m_Resources[resource.index].usage |= GetUsageInfo(usage).imageUsage;
+		return *this;
+	}
+
+	// ========================================================
+	// Graph declaration
+	// ========================================================
+	RenderGraph::~RenderGraph()
+	{
+		ReleaseTransients();
+	}
+
+	void RenderGraph::Reset()
+	{
+		m_Passes.clear();
+		m_Resources.clear();
+	}
+
+	RenderGraphResource RenderGraph::ImportImage(const std::string& name, std::shared_ptr<VulkanImage> image)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.image = std::move(image);
+		m_Resources.push_back(std::move(resource));
+
+		return RenderGraphResource{ static_cast<uint32_t>(m_Resources.size() - 1) };
+	}
+
+	RenderGraphResource RenderGraph::CreateImage(const std::string& name, const TransientImageDesc& desc)
+	{
+		Resource resource{};
+		resource.name = name;
+		resource.desc = desc;
+		resource.transient = true;
+		m_Resources.push_back(std::move(resource));
+
+		return RenderGraphResource{ static_cast<uint32_t>(m_Resources.size() - 1) };
+	}
+
+	void RenderGraph::SetOutput(RenderGraphResource resource, ImageUsage finalUsage)
+	{
+		auto& output = m_Resources[resource.index];
+		output.output = true;
+		output.finalUsage = finalUsage;
+		output.usage |= GetUsageInfo(finalUsage).imageUsage;
+	}
+
+	void RenderGraph::AddPass(const std::string& name, const SetupFn& setup, ExecuteFn execute)
+	{
+		m_Passes.push_back(Pass{ .name = name, .execute = std::move(execute) });
+
+		PassBuilder builder(*this, static_cast<uint32_t>(m_Passes.size() - 1));
+		setup(builder);
+	}
+
+	const std::shared_ptr<VulkanImage>& RenderGraph::GetImage(RenderGraphResource resource) const
+	{
+		return m_Resources[resource.index].image;
+	}
+
+	// ========================================================
+	// Compilation
+	// ========================================================
+	void RenderGraph::Compile()
+	{
+		CullPasses();
+		ComputeLifetimes();
+		AllocateTransients();
+	}
+
+	void RenderGraph::CullPasses()
+	{
+		// Walk backwards from the outputs: a pass is needed when it writes something a later needed pass reads.
+		// Writes don't end the need (load ops and blending read what is already there), which keeps this conservative.
+		std::vector<bool> needed(m_Resources.size(), false);
+		for (size_t i = 0; i < m_Resources.size(); ++i)
+		{
+			needed[i] = m_Resources[i].output;
+		}
+
+		m_CulledPassCount = 0;
+		for (auto pass = m_Passes.rbegin(); pass != m_Passes.rend(); ++pass)
+		{
+			pass->alive = pass->sideEffect || std::ranges::any_of(pass->accesses, [&needed](const ResourceAccess& access)
+				{
+					return access.write && needed[access.resource];
+				});
+
+			if (!pass->alive)
+			{
+				++m_CulledPassCount;
+				continue;
+			}
+
+			for (const auto& access : pass->accesses)
+			{
+				if (!access.write)
+				{
+					needed[access.resource] = true;
+				}
+			}
+		}
+	}
+
+	void RenderGraph::ComputeLifetimes()
+	{
+		for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
+		{
+			if (!m_Passes[passIndex].alive)
+			{
+				continue;
+			}
+
+			for (const auto& access : m_Passes[passIndex].accesses)
+			{
+				auto& resource = m_Resources[access.resource];
+				resource.firstPass = std::min(resource.firstPass, passIndex);
+				resource.lastPass = std::max(resource.lastPass, passIndex);
+			}
+		}
+	}
+
+	void RenderGraph::AllocateTransients()
+	{
+		VkDevice device = VulkanCore::GetDevice();
+
+		// Transients used by alive passes, in order of first use
+		std::vector<uint32_t> transients;
+		for (uint32_t i = 0; i < m_Resources.size(); ++i)
+		{
+			if (m_Resources[i].transient && m_Resources[i].firstPass != UINT32_MAX)
+			{
+				transients.push_back(i);
+			}
+		}
+		std::ranges::stable_sort(transients, {}, [this](uint32_t index) { return m_Resources[index].firstPass; });
+
+		// Greedy aliasing: reuse the best fitting slot whose last user finished before this first use
+		std::vector<MemorySlot> slots;
+		std::vector<uint32_t> assignment;
+		VkDeviceSize unaliasedSize = 0;
+		uint64_t key = Hash::FNV_OFFSET_BASIS;
+
+		for (uint32_t index : transients)
+		{
+			const auto& resource = m_Resources[index];
+			const VkImageCreateInfo imageInfo = MakeImageInfo(resource.desc, resource.usage);
+
+			VkDeviceImageMemoryRequirements requirementsInfo = { VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS };
+			requirementsInfo.pCreateInfo = &imageInfo;
+			VkMemoryRequirements2 requirements = { VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2 };
+			vkGetDeviceImageMemoryRequirements(device, &requirementsInfo, &requirements);
+			const VkMemoryRequirements& required = requirements.memoryRequirements;
+			unaliasedSize += required.size;
+
+			uint32_t best = UINT32_MAX;
+			for (uint32_t slotIndex = 0; slotIndex < slots.size(); ++slotIndex)
+			{
+				const auto& slot = slots[slotIndex];
+				if (slot.lastPass >= resource.firstPass || (slot.requirements.memoryTypeBits & required.memoryTypeBits) == 0)
+				{
+					continue;
+				}
+
+				// Prefer the smallest slot that already fits, otherwise the largest one to grow
+				if (best == UINT32_MAX)
+				{
+					best = slotIndex;
+					continue;
+				}
+				const VkDeviceSize bestSize = slots[best].requirements.size;
+				const VkDeviceSize size = slot.requirements.size;
+				const bool fits = size >= required.size;
+				const bool bestFits = bestSize >= required.size;
+				if ((fits && (!bestFits || size < bestSize)) || (!fits && !bestFits && size > bestSize))
+				{
+					best = slotIndex;
+				}
+			}
+
+			if (best == UINT32_MAX)
+			{
+				best = static_cast<uint32_t>(slots.size());
+				slots.push_back(MemorySlot{ .requirements = required });
+			}
+
+			auto& slot = slots[best];
+			slot.requirements.size = std::max(slot.requirements.size, required.size);
+			slot.requirements.alignment = std::max(slot.requirements.alignment, required.alignment);
+			slot.requirements.memoryTypeBits &= required.memoryTypeBits;
+			slot.lastPass = resource.lastPass;
+			assignment.push_back(best);
+
+			Hash::Combine(key, resource.desc.format);
+			Hash::Combine(key, resource.desc.extent);
+			Hash::Combine(key, resource.usage);
+			Hash::Combine(key, best);
+		}
+
+		// Same transients and same aliasing as the cached ones: bind them again
+		if (key != m_TransientKey || m_Physical.size() != transients.size())
+		{
+			ReleaseTransients();
+
+			VmaAllocator allocator = VulkanCore::GetVmaAllocator();
+			VmaAllocationCreateInfo allocInfo = {};
+			allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+			allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+			VkDeviceSize aliasedSize = 0;
+			for (auto& slot : slots)
+			{
+				CHECK_VK_RES(vmaAllocateMemory(allocator, &slot.requirements, &allocInfo, &slot.allocation, nullptr));
+				aliasedSize += slot.requirements.size;
+			}
+
+			for (size_t i = 0; i < transients.size(); ++i)
+			{
+				const auto& resource = m_Resources[transients[i]];
+				const VkImageCreateInfo imageInfo = MakeImageInfo(resource.desc, resource.usage);
+
+				VkImage image{ VK_NULL_HANDLE };
+				CHECK_VK_RES(vkCreateImage(device, &imageInfo, nullptr, &image));
+				CHECK_VK_RES(vmaBindImageMemory(allocator, slots[assignment[i]].allocation, image));
+
+				VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+				viewInfo.image = image;
+				viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+				viewInfo.format = resource.desc.format;
+				viewInfo.subresourceRange.aspectMask = GetAspect(resource.desc.format);
+				viewInfo.subresourceRange.levelCount = 1;
+				viewInfo.subresourceRange.layerCount = 1;
+
+				VkImageView view{ VK_NULL_HANDLE };
+				CHECK_VK_RES(vkCreateImageView(device, &viewInfo, nullptr, &view));
+
+				// The memory belongs to the slot, not to the image
+				m_Physical.push_back(PhysicalImage{
+					.image = std::make_shared<VulkanImage>(image, view, resource.desc.format, resource.desc.extent, VK_NULL_HANDLE),
+					.slot = assignment[i]
+					});
+			}
+
+			m_Slots = std::move(slots);
+			m_TransientKey = key;
+
+			LOG_DEBUG(fmt::runtime("Render graph transients: {0} images in {1} memory blocks, {2} KB ({3} KB without aliasing)"),
+				m_Physical.size(), m_Slots.size(), aliasedSize / 1024, unaliasedSize / 1024);
+		}
+
+		for (size_t i = 0; i < transients.size(); ++i)
+		{
+			auto& resource = m_Resources[transients[i]];
+			resource.physical = static_cast<uint32_t>(i);
+			resource.image = m_Physical[i].image;
+		}
+	}
+
+	void RenderGraph::ReleaseTransients()
+	{
+		if (m_Physical.empty() && m_Slots.empty())
+		{
+			return;
+		}
+
+		// Frames in flight may still render to them
+		VkDevice device = VulkanCore::GetDevice();
+		VmaAllocator allocator = VulkanCore::GetVmaAllocator();
+		for (const auto& slot : m_Slots)
+		{
+			DeletionQueue::PushFunction(vmaFreeMemory, allocator, slot.allocation);
+		}
+		for (const auto& physical : m_Physical)
+		{
+			DeletionQueue::PushFunction(vkDestroyImage, device, physical.image->GetRaw(), nullptr);
+			DeletionQueue::PushFunction(vkDestroyImageView, device, physical.image->GetView(), nullptr);
+		}
+
+		m_Physical.clear();
+		m_Slots.clear();
+		m_TransientKey = 0;
+	}
+
+	// ========================================================
+	// Execution
+	// ========================================================
+	void RenderGraph::CmdTransition(Synchronization::BarrierBatch& barriers, Resource& resource, ImageUsage usage)
+	{
+		auto& image = *resource.image;
+		const UsageInfo info = GetUsageInfo(usage);
+		MemorySlot* slot = resource.transient ? &m_Slots[m_Physical[resource.physical].slot] : nullptr;
+
+		if (slot && !resource.initialized)
+		{
+			// First use this frame: the content is discarded, but the previous user of the memory
+			// (an alias earlier in the frame, or the last one of the previous frame) must be done with it
+			image.SetSyncState(slot->lastStage, slot->lastAccess, VK_IMAGE_LAYOUT_UNDEFINED);
+			resource.initialized = true;
+		}
+
+		barriers.ImageBarrier(image, info.stage, info.access, info.layout, Synchronization::MakeRange(GetAspect(image.GetFormat())));
+
+		if (slot)
+		{
+			const auto& state = image.GetSyncState();
+			slot->lastStage = state.lastStage;
+			slot->lastAccess = state.lastAccess;
+		}
+	}
+
+	void RenderGraph::Execute(VkCommandBuffer cmdBuffer)
+	{
+		Synchronization::BarrierBatch barriers;
+		m_BarrierCount = 0;
+
+		for (auto& pass : m_Passes)
+		{
+			if (!pass.alive)
+			{
+				continue;
+			}
+
+			// Every transition the pass needs goes into one batch
+			for (const auto& access : pass.accesses)
+			{
+				CmdTransition(barriers, m_Resources[access.resource], access.usage);
+			}
+			m_BarrierCount += barriers.GetBarrierCount();
+			barriers.Flush(cmdBuffer);
+
+			pass.execute(cmdBuffer, *this);
+		}
+
+		// Hand the outputs over in their final state (e.g. present)
+		for (auto& resource : m_Resources)
+		{
+			if (resource.output && resource.image)
+			{
+				CmdTransition(barriers, resource, resource.finalUsage);
+			}
+		}
+		m_BarrierCount += barriers.GetBarrierCount();
+		barriers.Flush(cmdBuffer);
+	}
+
+}
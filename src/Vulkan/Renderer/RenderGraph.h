@@ -0,0 +1,174 @@
+#pragma once
+
+#include "VulkanImage.h"
+#include "VulkanSynchronization.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+namespace tiny_vulkan {
+
+	// How a pass touches an image. Each usage maps to the stage, access and layout the barriers are inferred from.
+	enum class ImageUsage
+	{
+		COLOR_ATTACHMENT,
+		DEPTH_ATTACHMENT,
+		TRANSFER_SRC,
+		TRANSFER_DST,
+		SAMPLED,
+		STORAGE_READ,
+		STORAGE_WRITE,
+		PRESENT
+	};
+
+	// Index of an image declared in a RenderGraph, valid until the next Reset().
+	struct RenderGraphResource
+	{
+		static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+		uint32_t index{ INVALID_INDEX };
+
+		[[nodiscard]] bool IsValid() const { return index != INVALID_INDEX; }
+	};
+
+	// Image owned by the graph. Its usage flags are gathered from the passes using it.
+	struct TransientImageDesc
+	{
+		VkFormat	format{ VK_FORMAT_UNDEFINED };
+		VkExtent3D	extent{ 0, 0, 1 };
+	};
+
+	/**
+	 * @brief Frame graph rebuilt every frame: passes declare the images they read and write,
+	 * Compile() culls the passes no output depends on and Execute() records each pass behind
+	 * one batched barrier inferred from the declarations.
+	 * Transient images live in memory shared with transients whose lifetimes don't overlap,
+	 * their content is undefined at first use (clear or fully overwrite them).
+	 * The physical transients are cached across frames and only rebuilt when their layout changes.
+	 */
+	class RenderGraph
+	{
+	public:
+		class PassBuilder
+		{
+		public:
+			PassBuilder& Read(RenderGraphResource resource, ImageUsage usage);
+			PassBuilder& Write(RenderGraphResource resource, ImageUsage usage);
+
+			// Keeps the pass even when no output depends on it (e.g. GPU readback, queries).
+			PassBuilder& SetSideEffect();
+
+		private:
+			friend class RenderGraph;
+			PassBuilder(RenderGraph& graph, uint32_t passIndex) : m_Graph(graph), m_PassIndex(passIndex) {}
+
+			PassBuilder& Access(RenderGraphResource resource, ImageUsage usage, bool write);
+
+			RenderGraph&	m_Graph;
+			uint32_t		m_PassIndex;
+		};
+
+		using SetupFn = std::function<void(PassBuilder&)>;
+		using ExecuteFn = std::function<void(VkCommandBuffer, const RenderGraph&)>;
+
+	public:
+		RenderGraph() = default;
+		~RenderGraph();
+
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+
+		// Drops the passes and resources of the previous frame, the physical transients stay cached.
+		void Reset();
+
+		// External image. Its sync state is tracked on the VulkanImage, so it carries over from frame to frame.
+		[[nodiscard]] RenderGraphResource ImportImage(const std::string& name, std::shared_ptr<VulkanImage> image);
+		[[nodiscard]] RenderGraphResource CreateImage(const std::string& name, const TransientImageDesc& desc);
+
+		// Marks a resource as a result of the frame: passes writing it are kept, finalUsage is applied after the last pass.
+		void SetOutput(RenderGraphResource resource, ImageUsage finalUsage);
+
+		void AddPass(const std::string& name, const SetupFn& setup, ExecuteFn execute);
+
+		void Compile();
+		void Execute(VkCommandBuffer cmdBuffer);
+
+		// Physical image of a resource, only valid inside pass execution (transients are bound at Compile()).
+		[[nodiscard]] const std::shared_ptr<VulkanImage>& GetImage(RenderGraphResource resource) const;
+
+		[[nodiscard]] uint32_t GetCulledPassCount() const { return m_CulledPassCount; }
+		[[nodiscard]] uint32_t GetBarrierCount() const { return m_BarrierCount; }
+
+	private:
+		struct ResourceAccess
+		{
+			uint32_t	resource;
+			ImageUsage	usage;
+			bool		write;
+		};
+
+		struct Pass
+		{
+			std::string					name;
+			ExecuteFn					execute;
+			std::vector<ResourceAccess>	accesses;
+			bool						sideEffect{ false };
+			bool						alive{ false };
+		};
+
+		struct Resource
+		{
+			std::string						name;
+			std::shared_ptr<VulkanImage>	image;				// Imported image, or bound transient after Compile()
+			TransientImageDesc				desc;
+			VkImageUsageFlags				usage{ 0 };			// Transients: union of the declared usages
+			bool							transient{ false };
+			bool							output{ false };
+			ImageUsage						finalUsage{ ImageUsage::PRESENT };
+			uint32_t						firstPass{ UINT32_MAX };	// Alive pass range, transients only
+			uint32_t						lastPass{ 0 };
+			uint32_t						physical{ UINT32_MAX };	// Index into m_Physical
+			bool							initialized{ false };	// Touched by an executed pass this frame
+		};
+
+		// Memory shared by transients with disjoint lifetimes
+		struct MemorySlot
+		{
+			VmaAllocation			allocation{ VK_NULL_HANDLE };
+			VkMemoryRequirements	requirements{};
+			uint32_t				lastPass{ 0 };		// Compile() bookkeeping
+			VkPipelineStageFlags2	lastStage{ VK_PIPELINE_STAGE_2_NONE };	// Last access to the memory by any alias
+			VkAccessFlags2			lastAccess{ VK_ACCESS_2_NONE };
+		};
+
+		struct PhysicalImage
+		{
+			std::shared_ptr<VulkanImage>	image;
+			uint32_t						slot{ 0 };
+		};
+
+		void CullPasses();
+		void ComputeLifetimes();
+		void AllocateTransients();
+		void ReleaseTransients();
+
+		void CmdTransition(Synchronization::BarrierBatch& barriers, Resource& resource, ImageUsage usage);
+
+	private:
+		std::vector<Pass>			m_Passes;
+		std::vector<Resource>		m_Resources;
+
+		std::vector<PhysicalImage>	m_Physical;
+		std::vector<MemorySlot>		m_Slots;
+		uint64_t					m_TransientKey{ 0 };	// Identity of the cached physical transients
+
+		uint32_t					m_CulledPassCount{ 0 };
+		uint32_t					m_BarrierCount{ 0 };
+	};
+
+}
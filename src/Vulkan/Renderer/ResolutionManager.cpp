@@ -0,0 +1,228 @@
+#include "ResolutionManager.h"
+#include "VulkanCore.h"
+#include "DeletionQueue.h"
+#include "LogSystem.h"
+
+namespace tiny_vulkan {
+
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		// The scale aims at TARGET of the budget and holds still inside [LOW, HIGH]
+		constexpr float BUDGET_TARGET = 0.90f;
+		constexpr float BUDGET_HIGH = 0.95f;
+		constexpr float BUDGET_LOW = 0.80f;
+
+		constexpr float SMOOTHING = 0.1f;		// Weight of the latest sample in the moving average
+		constexpr float STEP = 0.5f;			// Fraction of the way to the estimated scale taken per frame
+		constexpr float SCALE_QUANTUM = 64.0f;	// Scales snap to 1/64: noise doesn't move the render area
+	}
+
+	ResolutionManager::ResolutionManager()
+	{
+		CreateQueryPool();
+		Update(VulkanCore::GetOutputExtent());
+	}
+
+	ResolutionManager::~ResolutionManager()
+	{
+		ReleaseRenderTarget();
+		if (m_QueryPool != VK_NULL_HANDLE)
+		{
+			DeletionQueue::PushFunction(vkDestroyQueryPool, VulkanCore::GetDevice(), m_QueryPool, nullptr);
+		}
+	}
+
+	void ResolutionManager::Update(VkExtent2D outputExtent)
+	{
+		// ========================================================
+		// GPU time of the last frame recorded in this slot (completed, the slot was waited on)
+		// ========================================================
+		const uint32_t slot = VulkanCore::GetCurrentFrameIndex();
+		if (m_QueryPool != VK_NULL_HANDLE && m_PendingQueries[slot])
+		{
+			std::array<uint64_t, 2> timestamps = {};
+			const VkResult res = vkGetQueryPoolResults(VulkanCore::GetDevice(), m_QueryPool, slot * 2, 2,
+				sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+			if (res == VK_SUCCESS)
+			{
+				m_PendingQueries[slot] = false;
+				m_GpuTimeMs = static_cast<float>((timestamps[1] - timestamps[0]) & m_TimestampMask) * m_TimestampPeriodNs * 1e-6f;
+				UpdateScale(m_GpuTimeMs);
+			}
+		}
+
+		// ========================================================
+		// Output extent
+		// ========================================================
+		if (outputExtent.width != m_OutputExtent.width || outputExtent.height != m_OutputExtent.height)
+		{
+			ReleaseRenderTarget();
+			if (!VulkanCore::GetSettings().directToSwapchain)
+			{
+				CreateRenderTarget(outputExtent);
+			}
+			m_OutputExtent = outputExtent;
+		}
+	}
+
+	void ResolutionManager::CmdBeginFrame(VkCommandBuffer cmdBuffer)
+	{
+		if (m_QueryPool == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		const uint32_t slot = VulkanCore::GetCurrentFrameIndex();
+		vkCmdResetQueryPool(cmdBuffer, m_QueryPool, slot * 2, 2);
+		vkCmdWriteTimestamp2(cmdBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, m_QueryPool, slot * 2);
+	}
+
+	void ResolutionManager::CmdEndFrame(VkCommandBuffer cmdBuffer)
+	{
+		if (m_QueryPool == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		const uint32_t slot = VulkanCore::GetCurrentFrameIndex();
+		vkCmdWriteTimestamp2(cmdBuffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_QueryPool, slot * 2 + 1);
+		m_PendingQueries[slot] = true;
+	}
+
+	VkExtent2D ResolutionManager::GetRenderExtent() const
+	{
+		return VkExtent2D{
+			std::max(1u, static_cast<uint32_t>(static_cast<float>(m_OutputExtent.width) * m_Scale)),
+			std::max(1u, static_cast<uint32_t>(static_cast<float>(m_OutputExtent.height) * m_Scale))
+		};
+	}
+
+	void ResolutionManager::UpdateScale(float gpuTimeMs)
+	{
+		const auto& settings = VulkanCore::GetSettings();
+		if (!settings.dynamicResolution)
+		{
+			return;
+		}
+
+		m_SmoothedGpuTimeMs = m_SmoothedGpuTimeMs == 0.0f
+			? gpuTimeMs
+			: m_SmoothedGpuTimeMs + (gpuTimeMs - m_SmoothedGpuTimeMs) * SMOOTHING;
+
+		const float budget = settings.gpuBudgetMs;
+		if (m_SmoothedGpuTimeMs <= budget * BUDGET_HIGH && m_SmoothedGpuTimeMs >= budget * BUDGET_LOW)
+		{
+			return;
+		}
+
+		// Cost follows the pixel count, so the square of the scale
+		const float desired = m_Scale * std::sqrt(budget * BUDGET_TARGET / m_SmoothedGpuTimeMs);
+		float next = std::clamp(m_Scale + (desired - m_Scale) * STEP, settings.minRenderScale, 1.0f);
+		next = std::round(next * SCALE_QUANTUM) / SCALE_QUANTUM;
+		if (next == m_Scale)
+		{
+			return;
+		}
+
+		// The average would take several frames to see the new cost: predict it instead of overshooting
+		m_SmoothedGpuTimeMs *= (next * next) / (m_Scale * m_Scale);
+		m_Scale = next;
+	}
+
+	void ResolutionManager::CreateRenderTarget(VkExtent2D extent)
+	{
+		auto device = VulkanCore::GetDevice();
+		auto allocator = VulkanCore::GetVmaAllocator();
+
+		// Image Info
+		VkImageCreateInfo imageInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = COLOR_FORMAT;
+		imageInfo.extent = VkExtent3D{ extent.width, extent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage =
+			VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+			VK_IMAGE_USAGE_STORAGE_BIT |
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		// Allocation Info
+		VmaAllocationCreateInfo allocInfo = {};
+		allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+		allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+		allocInfo.priority = 1.0f;
+
+		// Create image
+		VkImage image{ VK_NULL_HANDLE };
+		VmaAllocation allocation{ VK_NULL_HANDLE };
+		CHECK_VK_RES(vmaCreateImage(allocator, &imageInfo, &allocInfo, &image, &allocation, nullptr));
+
+		// View Info
+		VkImageViewCreateInfo viewInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		viewInfo.image = image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = COLOR_FORMAT;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.layerCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+
+		VkImageView view{ VK_NULL_HANDLE };
+		CHECK_VK_RES(vkCreateImageView(device, &viewInfo, nullptr, &view));
+
+		m_RenderTarget = std::make_shared<VulkanImage>(image, view, COLOR_FORMAT, imageInfo.extent, allocation);
+
+		LOG_DEBUG(fmt::runtime("Render target allocated: {0}x{1}"), extent.width, extent.height);
+	}
+
+	void ResolutionManager::ReleaseRenderTarget()
+	{
+		if (!m_RenderTarget)
+		{
+			return;
+		}
+
+		// Frames in flight may still render to it
+		DeletionQueue::PushFunction(vkDestroyImageView, VulkanCore::GetDevice(), m_RenderTarget->GetView(), nullptr);
+		DeletionQueue::PushFunction(vmaDestroyImage, VulkanCore::GetVmaAllocator(), m_RenderTarget->GetRaw(), m_RenderTarget->GetAllocation());
+		m_RenderTarget.reset();
+	}
+
+	void ResolutionManager::CreateQueryPool()
+	{
+		// Timestamps need a queue that writes them and a known tick length
+		uint32_t familyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(VulkanCore::GetPhysicalDevice(), &familyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> families(familyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(VulkanCore::GetPhysicalDevice(), &familyCount, families.data());
+
+		VkPhysicalDeviceProperties props;
+		vkGetPhysicalDeviceProperties(VulkanCore::GetPhysicalDevice(), &props);
+
+		const uint32_t validBits = families[VulkanCore::GetGraphicsFamily()].timestampValidBits;
+		if (validBits == 0 || props.limits.timestampPeriod == 0.0f)
+		{
+			if (VulkanCore::GetSettings().dynamicResolution)
+			{
+				LOG_WARN("GPU timestamps unsupported on the graphics queue, dynamic resolution disabled");
+			}
+			return;
+		}
+		m_TimestampPeriodNs = props.limits.timestampPeriod;
+		m_TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+		const uint32_t slotCount = VulkanCore::GetFlightFrameCount();
+		VkQueryPoolCreateInfo poolInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+		poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		poolInfo.queryCount = slotCount * 2;
+		CHECK_VK_RES(vkCreateQueryPool(VulkanCore::GetDevice(), &poolInfo, nullptr, &m_QueryPool));
+
+		m_PendingQueries.assign(slotCount, false);
+	}
+
+}
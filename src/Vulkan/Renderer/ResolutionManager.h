@@ -0,0 +1,67 @@
+#pragma once
+
+#include "VulkanImage.h"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+namespace tiny_vulkan {
+
+	/**
+	 * @brief Owns the scene render target and picks the resolution the scene renders at.
+	 * The target is sized to the output (swapchain, or headless) extent and reallocated when it changes.
+	 * With dynamic resolution, the scene renders to the top-left renderExtent of it, a fraction
+	 * of the output driven by the GPU frame time (timestamps), and the copy to the swapchain upscales.
+	 * Scale changes never reallocate: only the render area and the blit source region move.
+	 * In direct-to-swapchain mode there is no render target, only the timing and the (unscaled) extents.
+	 */
+	class ResolutionManager
+	{
+	public:
+		static constexpr VkFormat COLOR_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+		ResolutionManager();
+		~ResolutionManager();
+
+		ResolutionManager(const ResolutionManager&) = delete;
+		ResolutionManager& operator=(const ResolutionManager&) = delete;
+
+		/**
+		 * @brief Frame boundary, once the current frame slot is free: reads the GPU time its previous
+		 * frame measured, adapts the scale and follows the output extent.
+		 */
+		void Update(VkExtent2D outputExtent);
+
+		// Bracket the frame's command buffer, outside any rendering scope.
+		void CmdBeginFrame(VkCommandBuffer cmdBuffer);
+		void CmdEndFrame(VkCommandBuffer cmdBuffer);
+
+		[[nodiscard]] const std::shared_ptr<VulkanImage>& GetRenderTarget() const { return m_RenderTarget; }	// Null in direct mode
+		[[nodiscard]] VkExtent2D	GetOutputExtent()	const { return m_OutputExtent; }
+		[[nodiscard]] VkExtent2D	GetRenderExtent()	const;
+		[[nodiscard]] float			GetScale()			const { return m_Scale; }
+		[[nodiscard]] float			GetGpuTimeMs()		const { return m_GpuTimeMs; }	// Last measured frame, 0 if unknown
+
+	private:
+		void CreateRenderTarget(VkExtent2D extent);
+		void ReleaseRenderTarget();
+		void CreateQueryPool();
+		void UpdateScale(float gpuTimeMs);
+
+	private:
+		std::shared_ptr<VulkanImage>	m_RenderTarget;
+		VkExtent2D						m_OutputExtent{ 0, 0 };
+		float							m_Scale{ 1.0f };
+
+		// GPU timing: a begin/end timestamp pair per frame slot
+		VkQueryPool						m_QueryPool{ VK_NULL_HANDLE };
+		std::vector<bool>				m_PendingQueries;	// Per slot: written by a submitted frame, not read yet
+		float							m_TimestampPeriodNs{ 0.0f };
+		uint64_t						m_TimestampMask{ ~0ull };	// Bits the queue writes, deltas wrap past them
+		float							m_GpuTimeMs{ 0.0f };
+		float							m_SmoothedGpuTimeMs{ 0.0f };
+	};
+
+}
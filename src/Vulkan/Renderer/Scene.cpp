@@ -1,36 +1,77 @@
 #include "Scene.h"
-#include "Application.h"
 #include "AssetLoader.h"
 #include "VulkanCore.h"
+#include "ResolutionManager.h"
+#include "ShaderHotReload.h"
+#include "GpuResources.h"
+#include "CommandsExecutor.h"
+#include "AsyncCompute.h"
 #include "VulkanSynchronization.h"
 
+#include <algorithm>
+
 namespace tiny_vulkan {
 
 	Scene::Scene()
 	{
 		// Prepare
-		m_Window = Application::GetRaw()->GetWindow();
-
 		std::filesystem::path wd = std::filesystem::current_path() / ".." / "src" / "EntryPoint" / "Assets";
 
 		// Meshes
 		m_Meshes = Loader::LoadGLTFMeshes(wd / "Gltf" / "KV2" / "kv-2_heavy_tank_1940.glb").value();
 
-		// Shaders
-		m_VertexShader = std::make_shared<VulkanShader>(wd / "Shaders" / "vertexShader.vert");
-		m_FragmentShader = std::make_shared<VulkanShader>(wd / "Shaders" / "fragmentShader.frag");
+		// The compute queue reads the vertices from the first frame on: let the uploads land first
+		CommandExecutor::Execute({});
 
-		// Pipeline
-		VkPushConstantRange pushRange;
-		pushRange.offset = 0;
-		pushRange.size = sizeof(ScenePushConstants);
-		pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		// Transformed positions, one set per frame in flight
+		m_Positions.resize(VulkanCore::GetFlightFrameCount());
+		for (auto& positions : m_Positions)
+		{
+			for (const auto& mesh : m_Meshes)
+			{
+				auto& position = positions.emplace_back();
+				position.buffer = VulkanBufferBuilder()
+					.SetAllocationPlace(VMA_MEMORY_USAGE_GPU_ONLY)
+					.SetAllocationSize(std::max<size_t>(mesh->vertexCount, 1) * sizeof(glm::vec4))
+					.SetUsageMask(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+					.Build();
+
+				VkBufferDeviceAddressInfo addressInfo = { VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO };
+				addressInfo.buffer = position.buffer->GetRaw();
+				position.address = vkGetBufferDeviceAddress(VulkanCore::GetDevice(), &addressInfo);
+			}
+		}
 
-		std::vector<VkFormat> pipelineFormats = { VulkanCore::GetRenderTarget()->GetFormat() };
+		// Shaders
+		auto shaders = VulkanShader::CompileBatch({
+			wd / "Shaders" / "vertexShader.vert",
+			wd / "Shaders" / "fragmentShader.frag",
+			wd / "Shaders" / "vertexTransform.comp"
+			});
+		m_VertexShader = shaders[0];
+		m_FragmentShader = shaders[1];
+		m_TransformShader = shaders[2];
+
+		// Pipelines, rebuilt when the shaders are edited
+		m_Pipeline = ShaderHotReload::BuildWatched(MakePipelineBuilder());
+
+		VulkanPipelineBuilder transformBuilder;
+		m_TransformPipeline = ShaderHotReload::BuildWatched(transformBuilder
+			.SetPipelineType(PipelineType::COMPUTE)
+			.AddShader(m_TransformShader));
+	}
 
-		m_Pipeline = VulkanPipelineBuilder()
+	VulkanPipelineBuilder Scene::MakePipelineBuilder() const
+	{
+		// Push constant range is reflected from the shaders
+		// The color target is the swapchain image in direct mode
+		std::vector<VkFormat> pipelineFormats = {
+			VulkanCore::GetSettings().directToSwapchain ? VulkanCore::GetSwapchain()->GetFormat() : ResolutionManager::COLOR_FORMAT
+		};
+
+		VulkanPipelineBuilder builder;
+		return builder
 			.SetPipelineType(PipelineType::GRAPHICS)
-			.AddPushConstantRange(pushRange)
 			.AddShader(m_VertexShader)
 			.AddShader(m_FragmentShader)
 			.SetColorAttachmentFormats(pipelineFormats)
@@ -41,39 +82,95 @@ namespace tiny_vulkan {
 			.SetPolygonMode(VK_POLYGON_MODE_FILL)
 			.SetCullMode(VK_CULL_MODE_BACK_BIT)
 			.SetFrontFace(VK_FRONT_FACE_CLOCKWISE)
-			.Build();
+			.EnableDynamicState(true);
 	}
 
-	void Scene::Render()
+	void Scene::Update(VkExtent2D renderExtent)
+	{
+		auto& positions = m_Positions[VulkanCore::GetCurrentFrameIndex()];
+		const uint32_t computeFamily = VulkanCore::GetComputeFamily();
+		const uint32_t graphicsFamily = VulkanCore::GetGraphicsFamily();
+
+		// Constants
+		glm::mat4 view = glm::translate(glm::vec3{ 0,0,-2 });
+		glm::mat4 projection = glm::perspective(glm::radians(40.f), (float)renderExtent.width / (float)renderExtent.height, 10000.f, 0.1f);
+		projection[1][1] *= -1;
+
+		// The vertex stage of this frame is the first consumer, earlier graphics work overlaps the transform
+		AsyncCompute::Submit([&](VkCommandBuffer cmdBuffer)
+			{
+				Synchronization::BarrierBatch barriers;
+
+				// Overwritten whole, and the frame that drew them last completed (BeginFrame waited for it):
+				// neither the old contents nor the graphics ownership need to come back, only the writes are tracked
+				for (auto& position : positions)
+				{
+					position.buffer->SetSyncState(0, VK_WHOLE_SIZE, BufferSyncState{});
+					barriers.BufferBarrier(*position.buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+				}
+
+				m_TransformPipeline->CmdBind(cmdBuffer);
+				for (size_t i = 0; i < m_Meshes.size(); ++i)
+				{
+					const auto& mesh = m_Meshes[i];
+
+					TransformPushConstants constants{};
+					constants.worldMatrix = projection * view;
+					constants.vertexCount = mesh->vertexCount;
+					constants.vertexBufferAddress = mesh->vertexBufferAddress;
+					constants.positionBufferAddress = positions[i].address;
+					vkCmdPushConstants(cmdBuffer, m_TransformPipeline->GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(TransformPushConstants), &constants);
+
+					vkCmdDispatch(cmdBuffer, (mesh->vertexCount + 63) / 64, 1, 1);
+				}
+
+				// Handed to the graphics queue, Render acquires them
+				for (auto& position : positions)
+				{
+					barriers.ReleaseBuffer(*position.buffer, computeFamily, graphicsFamily);
+				}
+				barriers.Flush(cmdBuffer);
+			},
+			VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT);
+	}
+
+	void Scene::Render(VkCommandBuffer cmdBuffer, const VulkanImage& colorTarget, const VulkanImage& depthTarget, VkExtent2D renderExtent)
 	{
 		// Prepare
-		auto cmdBuffer = VulkanCore::GetCurrentFrame()->GetCmdBuffer();
-		auto rt = VulkanCore::GetRenderTarget();
-		auto rtExtent = rt->GetExtent();
-		auto depth = VulkanCore::GetDepthImage();
+		auto rtExtent = renderExtent;
+		const auto& positions = m_Positions[VulkanCore::GetCurrentFrameIndex()];
+
+		// Second half of the transfer Update released, the frame submit waits for the compute at the vertex stage
+		Synchronization::BarrierBatch barriers;
+		for (const auto& position : positions)
+		{
+			barriers.AcquireBuffer(*position.buffer, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+				VulkanCore::GetComputeFamily(), VulkanCore::GetGraphicsFamily());
+		}
+		barriers.Flush(cmdBuffer);
 
 		VkRenderingAttachmentInfo attachmentInfo = {};
 		attachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
 		attachmentInfo.pNext = nullptr;
-		attachmentInfo.imageView = rt->GetView();
+		attachmentInfo.imageView = colorTarget.GetView();
 		attachmentInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		attachmentInfo.resolveMode = VK_RESOLVE_MODE_NONE;
 		attachmentInfo.resolveImageView = VK_NULL_HANDLE;
 		attachmentInfo.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD; // load operations define the initial values of an attachment during a render pass instance
+		attachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; // load operations define the initial values of an attachment during a render pass instance
 		attachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE; // define how values written to an attachment during a render pass instance are stored to memory
-		attachmentInfo.clearValue = {};
+		attachmentInfo.clearValue = {}; // Previous content is never needed (swapchain images rotate in direct mode)
 
 		VkRenderingAttachmentInfo depthAttachmentInfo = {};
 		depthAttachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
 		depthAttachmentInfo.pNext = nullptr;
-		depthAttachmentInfo.imageView = depth->GetView();
+		depthAttachmentInfo.imageView = depthTarget.GetView();
 		depthAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
 		depthAttachmentInfo.resolveMode = VK_RESOLVE_MODE_NONE;
 		depthAttachmentInfo.resolveImageView = VK_NULL_HANDLE;
 		depthAttachmentInfo.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 		depthAttachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; 
-		depthAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		depthAttachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // Transient, nothing reads it after the pass
 		depthAttachmentInfo.clearValue.depthStencil.depth = 0.0f;
 
 		VkRenderingInfo renderingInfo = {};
@@ -88,24 +185,10 @@ namespace tiny_vulkan {
 		renderingInfo.pDepthAttachment = &depthAttachmentInfo;
 		renderingInfo.pStencilAttachment = nullptr;
 		
-		Synchronization::CmdImageMemoryBarrier(cmdBuffer, rt,
-			VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-			VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-			VK_IMAGE_ASPECT_COLOR_BIT
-		);
-
-		Synchronization::CmdImageMemoryBarrier(cmdBuffer, depth,
-			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-			VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
-			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-			VK_IMAGE_ASPECT_DEPTH_BIT
-		);
-
 		// Begin rendering
 		vkCmdBeginRendering(cmdBuffer, &renderingInfo);
 
-		vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline->GetRaw());
+		m_Pipeline->CmdBind(cmdBuffer);
 
 		VkViewport viewport = {};
 		viewport.x = 0;
@@ -114,27 +197,29 @@ namespace tiny_vulkan {
 		viewport.height = (float) rtExtent.height;
 		viewport.minDepth = 0.0f;
 		viewport.maxDepth = 1.0f;
-		vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
 
 		VkRect2D scissor = {};
 		scissor.extent.width = rtExtent.width;
 		scissor.extent.height = rtExtent.height;
 		scissor.offset.x = 0;
 		scissor.offset.y = 0;
-		vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+		m_Pipeline->CmdSetViewportAndScissor(cmdBuffer, viewport, scissor);
 
-		for (auto mesh : m_Meshes)
+		for (size_t i = 0; i < m_Meshes.size(); ++i)
 		{
-			// Constants
-			glm::mat4 view = glm::translate(glm::vec3{ 0,0,-2 });
-			glm::mat4 projection = glm::perspective(glm::radians(40.f), (float)m_Window->GetWidth() / (float)m_Window->GetHeight(), 10000.f, 0.1f);
-			projection[1][1] *= -1;
-
+			const auto& mesh = m_Meshes[i];
+			const VulkanBuffer* indexBuffer = GpuResources::GetBuffer(mesh->indexBuffer);
+			if (!indexBuffer)
+			{
+				continue;
+			}
+
+			// Positions come transformed from Update
 			m_ScenePushConstants.vertexBufferAddress = mesh->vertexBufferAddress;
-			m_ScenePushConstants.worldMatrix = projection * view;
+			m_ScenePushConstants.positionBufferAddress = positions[i].address;
 			vkCmdPushConstants(cmdBuffer, m_Pipeline->GetLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ScenePushConstants), &m_ScenePushConstants);
 
-			vkCmdBindIndexBuffer(cmdBuffer, mesh->indexBuffer->GetRaw(), 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindIndexBuffer(cmdBuffer, indexBuffer->GetRaw(), 0, VK_INDEX_TYPE_UINT32);
 			vkCmdDrawIndexed(cmdBuffer, mesh->subMeshesGeo[0].count, 1, mesh->subMeshesGeo[0].startIndex, 0, 0);
 		}
 
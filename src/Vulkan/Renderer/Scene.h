@@ -1,9 +1,9 @@
 #pragma once
 
-#include "Window.h"
 #include "Mesh.h"
 #include "VulkanPipeline.h"
 #include "VulkanShader.h"
+#include "VulkanImage.h"
 #include <memory>
 #include <array>
 #include <glm/glm.hpp>
@@ -12,9 +12,18 @@
 namespace tiny_vulkan {
 
 	struct ScenePushConstants
+	{
+		VkDeviceAddress vertexBufferAddress;
+		VkDeviceAddress positionBufferAddress;
+	};
+
+	// vertexTransform.comp, same std430 layout
+	struct TransformPushConstants
 	{
 		glm::mat4 worldMatrix;
+		uint32_t vertexCount;
 		VkDeviceAddress vertexBufferAddress;
+		VkDeviceAddress positionBufferAddress;
 	};
 
 	class Scene
@@ -26,16 +35,36 @@ namespace tiny_vulkan {
 		Scene(const Scene&) = delete;
 		Scene& operator=(const Scene&) = delete;
 
-		// Required commands in order to draw a scene (renderer will call it).
-		void Render();
+		// Transforms the vertices of this frame on the compute queue (AsyncCompute), Render draws them.
+		// Once per frame, before the frame's render graph executes.
+		void Update(VkExtent2D renderExtent);
+
+		// Required commands in order to draw a scene (the renderer's scene pass calls it).
+		// The targets are already transitioned to their attachment layouts, depth is cleared here.
+		// Only the top-left renderExtent of the targets is rendered (dynamic resolution).
+		void Render(VkCommandBuffer cmdBuffer, const VulkanImage& colorTarget, const VulkanImage& depthTarget, VkExtent2D renderExtent);
+
+		// Description of the scene pipeline, also the material the pipeline benchmark measures
+		[[nodiscard]] VulkanPipelineBuilder MakePipelineBuilder() const;
+
+	private:
+		struct PositionBuffer
+		{
+			std::shared_ptr<VulkanBuffer>	buffer;
+			VkDeviceAddress					address{ 0 };
+		};
 
 	private:
 		ScenePushConstants m_ScenePushConstants;
 		std::shared_ptr<VulkanPipeline> m_Pipeline;
+		std::shared_ptr<VulkanPipeline> m_TransformPipeline;
 		std::shared_ptr<VulkanShader> m_VertexShader;
 		std::shared_ptr<VulkanShader> m_FragmentShader;
+		std::shared_ptr<VulkanShader> m_TransformShader;
 		std::vector<std::shared_ptr<Mesh>> m_Meshes;
-		std::shared_ptr<Window> m_Window;
+
+		// Clip space positions per frame slot, then per mesh: a frame transforms while the previous ones draw
+		std::vector<std::vector<PositionBuffer>> m_Positions;
 	};
 
 }
\ No newline at end of file
@@ -4,13 +4,10 @@
 
 namespace tiny_vulkan {
 
-	std::vector<VkSemaphore> VulkanFrame::s_RenderSemaphores;
-
 	VulkanFrame::VulkanFrame()
 	{
 		auto device					= VulkanCore::GetDevice();
 		auto graphicsFamily			= VulkanCore::GetGraphicsFamily();
-		auto swapchainImageCount	= VulkanCore::GetSwapchain()->GetImages().size();
 
 		// ========================================================
 		// VkCommandPool
@@ -34,32 +31,15 @@ namespace tiny_vulkan {
 		// ========================================================
 		// Synchronization (Per Frame)
 		// ========================================================
-		VkFenceCreateInfo fenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-		CHECK_VK_RES(vkCreateFence(device, &fenceInfo, nullptr, &m_RenderFence));
-
+		// Completion is tracked on the frame timeline (VulkanCore), only acquire needs a per-frame semaphore.
+		// Render semaphores are per swapchain image and live with the swapchain.
 		VkSemaphoreCreateInfo semaphoreInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
 		CHECK_VK_RES(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_ImageAcquireSemaphore));
 
-		// ========================================================
-		// Static Synchronization (Per Swapchain Image)
-		// ========================================================
-		if (s_RenderSemaphores.empty()) [[unlikely]]
-		{
-			s_RenderSemaphores.resize(swapchainImageCount);
-
-			for (uint32_t i = 0; i < swapchainImageCount; ++i)
-			{
-				CHECK_VK_RES(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &s_RenderSemaphores[i]));
-				LifetimeManager::PushFunction(vkDestroySemaphore, device, s_RenderSemaphores[i], nullptr);
-			}
-		}
-
 		// ========================================================
 		// Register cleanup for instance resources
 		// ========================================================
 		LifetimeManager::PushFunction(vkDestroyCommandPool, device, m_Pool, nullptr);
-		LifetimeManager::PushFunction(vkDestroyFence, device, m_RenderFence, nullptr);
 		LifetimeManager::PushFunction(vkDestroySemaphore, device, m_ImageAcquireSemaphore, nullptr);
 	}
 
@@ -1,45 +1,240 @@
 #include "Renderer/VulkanRenderer.h"
 #include "VulkanCore.h"
-#include "VulkanSynchronization.h"
+#include "VulkanExtensions.h"
 #include "ImageOperations.h"
+#include "AsyncCompute.h"
+#include "PipelineLibrary.h"
+#include "PipelineBenchmark.h"
+#include "ShaderHotReload.h"
+#include "DeletionQueue.h"
+#include "Filesystem.h"
 #include "LogSystem.h"
 
+#include <glm/gtc/packing.hpp>
+
 namespace tiny_vulkan {
 
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		// First stages touching the swapchain image, they wait for the acquire semaphore
+		constexpr VkPipelineStageFlags2 ACQUIRE_WAIT_STAGES = VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+		// Bounds the present wait: a hidden or minimized window may never display the frame
+		constexpr uint64_t PRESENT_WAIT_TIMEOUT_NS = 100'000'000;
+
+		constexpr std::chrono::seconds FRAME_STATS_INTERVAL{ 5 };
+	}
+
 	VulkanRenderer::VulkanRenderer(std::shared_ptr<Window> window)
 		: m_Window(window)
 	{
 		m_Scene = std::make_shared<Scene>();
-		m_ImGuiRenderer = std::make_shared<ImGuiRenderer>(m_Window);
+
+		// Headless: no window to draw the UI in
+		if (m_Window)
+		{
+			m_ImGuiRenderer = std::make_shared<ImGuiRenderer>(m_Window);
+		}
 	}
 
 	void VulkanRenderer::Draw()
 	{
-		BeginFrame();
-		if (m_InvalidSwapchain) return;
+		if (!BeginFrame()) return;
 
-		m_Scene->Render();
+		m_Scene->Update(m_Resolution.GetRenderExtent());
+		BuildRenderGraph();
+		m_RenderGraph.Execute(VulkanCore::GetCurrentFrame()->GetCmdBuffer());
 
 		EndFrame();
-		if (m_InvalidSwapchain) return;
+		UpdateFrameStats();
 	}
 
-	void VulkanRenderer::BeginFrame()
+	bool VulkanRenderer::SaveRenderTarget(const std::filesystem::path& path)
 	{
-		auto	device				= VulkanCore::GetDevice();
-		auto	swapchain			= VulkanCore::GetSwapchain()->GetRaw();
-		auto&	frame				= VulkanCore::GetCurrentFrame();
-		auto    renderFence			= frame->GetRenderFence();
-		auto	imgAcqSemaphore		= frame->GetImageAcquireSemaphore();
+		const auto& rt = m_Resolution.GetRenderTarget();
+		if (!rt)
+		{
+			LOG_ERROR("No render target to save in direct-to-swapchain mode");
+			return false;
+		}
 
-		CHECK_VK_RES(vkWaitForFences(device, 1, &renderFence, VK_TRUE, UINT64_MAX));
-		CHECK_VK_RES(vkResetFences(device, 1, &renderFence));
+		// Waits for the queue: every submitted frame has landed in the target
+		const VkExtent2D extent = m_Resolution.GetRenderExtent();
+		const std::vector<uint8_t> texels = ImageOperations::Readback(*rt, extent);
+		if (texels.empty())
+		{
+			return false;
+		}
 
-		if (vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imgAcqSemaphore, VK_NULL_HANDLE, &m_CurrentImageIndex) == VK_ERROR_OUT_OF_DATE_KHR)
+		// HDR half floats to 8-bit, clamped: deterministic for a given driver, which is what image diffs need
+		static_assert(ResolutionManager::COLOR_FORMAT == VK_FORMAT_R16G16B16A16_SFLOAT, "Conversion expects RGBA16F texels");
+		const size_t pixelCount = static_cast<size_t>(extent.width) * extent.height;
+		std::vector<uint8_t> rgb(pixelCount * 3);
+		for (size_t i = 0; i < pixelCount; ++i)
+		{
+			uint64_t packed = 0;
+			std::memcpy(&packed, texels.data() + i * sizeof(packed), sizeof(packed));
+			const glm::vec4 color = glm::clamp(glm::unpackHalf4x16(packed), 0.0f, 1.0f);
+
+			rgb[i * 3 + 0] = static_cast<uint8_t>(color.r * 255.0f + 0.5f);
+			rgb[i * 3 + 1] = static_cast<uint8_t>(color.g * 255.0f + 0.5f);
+			rgb[i * 3 + 2] = static_cast<uint8_t>(color.b * 255.0f + 0.5f);
+		}
+
+		if (!IO::WritePPM(path, extent.width, extent.height, rgb))
+		{
+			return false;
+		}
+		LOG_INFO(fmt::runtime("Render target saved: {0} ({1}x{2})"), path.string(), extent.width, extent.height);
+		return true;
+	}
+
+	void VulkanRenderer::BenchmarkPipelines()
+	{
+		PipelineBenchmark::Run(m_Scene->MakePipelineBuilder());
+	}
+
+	void VulkanRenderer::UpdateFrameStats()
+	{
+		if (!VulkanCore::GetSettings().logFrameStats)
+		{
+			return;
+		}
+
+		// GPU time lags by the frames in flight, it's the latest the timestamps delivered
+		++m_FrameStats.frameCount;
+		m_FrameStats.gpuTimeMs += m_Resolution.GetGpuTimeMs();
+		m_FrameStats.barrierCount += m_RenderGraph.GetBarrierCount();
+
+		const auto now = std::chrono::steady_clock::now();
+		const std::chrono::duration<double, std::milli> elapsed = now - m_FrameStats.intervalStart;
+		if (elapsed < FRAME_STATS_INTERVAL)
 		{
-			m_InvalidSwapchain = true;
 			return;
 		}
+
+		const double frames = static_cast<double>(m_FrameStats.frameCount);
+		const VkExtent2D renderExtent = m_Resolution.GetRenderExtent();
+		const char* mode = VulkanCore::IsHeadless() ? "headless" : VulkanCore::GetSettings().directToSwapchain ? "direct" : "render target + blit";
+		LOG_INFO(fmt::runtime("Frame stats ({0}, {1}x{2}): {3:.2f} ms/frame ({4:.0f} fps), GPU {5:.2f} ms, {6:.1f} barriers/frame"),
+			mode,
+			renderExtent.width,
+			renderExtent.height,
+			elapsed.count() / frames,
+			frames * 1000.0 / elapsed.count(),
+			m_FrameStats.gpuTimeMs / frames,
+			static_cast<double>(m_FrameStats.barrierCount) / frames
+		);
+
+		m_FrameStats = FrameStats{ .intervalStart = now };
+	}
+
+	void VulkanRenderer::WaitForPresent()
+	{
+		if (!VulkanCore::GetSettings().lowLatency)
+		{
+			return;
+		}
+
+		if (VulkanCore::GetCapabilities().presentWait)
+		{
+			// Ids are per swapchain: a present to a retired swapchain can't be waited on the new one
+			auto swapchain = VulkanCore::GetSwapchain()->GetRaw();
+			if (m_LastPresentId == 0 || m_LastPresentSwapchain != swapchain)
+			{
+				return;
+			}
+
+			const VkResult res = Extensions::WaitForPresentKHR(VulkanCore::GetDevice(), swapchain, m_LastPresentId, PRESENT_WAIT_TIMEOUT_NS);
+			if (res != VK_TIMEOUT && res != VK_SUBOPTIMAL_KHR && res != VK_ERROR_OUT_OF_DATE_KHR)
+			{
+				CHECK_VK_RES(res);
+			}
+		}
+		else if (VulkanCore::GetFrameNumber() > 1)
+		{
+			// No present wait: at least keep the CPU from queuing frames ahead of the GPU
+			VulkanCore::WaitForFrame(VulkanCore::GetFrameNumber() - 1);
+		}
+	}
+
+	bool VulkanRenderer::RecreateSwapchain()
+	{
+		// Minimized: nothing to present, keep the swapchain flagged until the window comes back
+		m_Window->Update();
+		if (m_Window->GetWidth() == 0 || m_Window->GetHeight() == 0)
+		{
+			return false;
+		}
+
+		VulkanCore::GetSwapchain()->RecreateSwapchain(m_Window->GetWidth(), m_Window->GetHeight());
+		m_InvalidSwapchain = false;
+
+		LOG_INFO(fmt::runtime("Swapchain recreated: {0}x{1}"), m_Window->GetWidth(), m_Window->GetHeight());
+		return true;
+	}
+
+	bool VulkanRenderer::AcquireSwapchainImage()
+	{
+		// Every resize since the last frame is coalesced into one rebuild, made here at the frame boundary
+		// where the retired swapchains whose presents are done get released
+		if (m_Window->ConsumeResize())
+		{
+			m_InvalidSwapchain = true;
+		}
+		if (m_InvalidSwapchain && !RecreateSwapchain())
+		{
+			return false;
+		}
+		VulkanCore::GetSwapchain()->ReleaseRetired();
+
+		auto	device			= VulkanCore::GetDevice();
+		auto	swapchain		= VulkanCore::GetSwapchain()->GetRaw();
+		auto	imgAcqSemaphore	= VulkanCore::GetCurrentFrame()->GetImageAcquireSemaphore();
+		const VkResult acquireResult = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, imgAcqSemaphore, VK_NULL_HANDLE, &m_CurrentImageIndex);
+		if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			m_InvalidSwapchain = true;
+			return false;
+		}
+		if (acquireResult == VK_SUBOPTIMAL_KHR)
+		{
+			// Still presentable: render this frame, rebuild at the next boundary
+			m_InvalidSwapchain = true;
+		}
+		else
+		{
+			CHECK_VK_RES(acquireResult);
+		}
+		return true;
+	}
+
+	bool VulkanRenderer::BeginFrame()
+	{
+		auto&	frame				= VulkanCore::GetCurrentFrame();
+		auto	frameNumber			= VulkanCore::GetFrameNumber();
+		auto	framesInFlight		= VulkanCore::GetFlightFrameCount();
+
+		// This frame slot was last used by frame N - framesInFlight
+		if (frameNumber > framesInFlight)
+		{
+			VulkanCore::WaitForFrame(frameNumber - framesInFlight);
+		}
+
+		// Frame boundary: release what the completed frames no longer use,
+		// then swap in pipelines whose optimized link or shader reload finished in the background
+		DeletionQueue::Collect(VulkanCore::GetCompletedFrame());
+		PipelineLibrary::ProcessCompletedLinks();
+		ShaderHotReload::Update();
+
+		// Headless frames render offscreen, there's no image to acquire
+		if (!VulkanCore::IsHeadless() && !AcquireSwapchainImage())
+		{
+			return false;
+		}
+		// Follows the (possibly recreated) swapchain and the GPU time measured in this slot
+		m_Resolution.Update(VulkanCore::GetOutputExtent());
+
 		CHECK_VK_RES(vkResetCommandBuffer(frame->GetCmdBuffer(), 0));
 
 		// Prepare cmd buffer for commands recording
@@ -47,100 +242,196 @@ namespace tiny_vulkan {
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 		CHECK_VK_RES(vkBeginCommandBuffer(frame->GetCmdBuffer(), &beginInfo));
+		m_Resolution.CmdBeginFrame(frame->GetCmdBuffer());
+		return true;
 	}
 
 	void VulkanRenderer::EndFrame()
 	{
 		auto&	frame			= VulkanCore::GetCurrentFrame();
 		auto	cmdBuffer		= frame->GetCmdBuffer();
-		auto	swImage			= VulkanCore::GetSwapchain()->GetImages()[m_CurrentImageIndex];
 		auto	graphicsQueue	= VulkanCore::GetGraphicsQueue();
-		auto	presentQueue	= VulkanCore::GetPresentQueue();
-		auto	rawSwapchain	= VulkanCore::GetSwapchain()->GetRaw();
-
-		CopyRenderTargetToSwapchain();
-		DrawImGuiToSwapchain();
-
-		Synchronization::CmdImageMemoryBarrier(cmdBuffer, swImage,
-			VK_PIPELINE_STAGE_2_NONE,
-			VK_ACCESS_2_NONE,
-			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-			VK_IMAGE_ASPECT_COLOR_BIT
-		);
+		const bool headless		= VulkanCore::IsHeadless();
 
+		m_Resolution.CmdEndFrame(cmdBuffer);
 		CHECK_VK_RES(vkEndCommandBuffer(cmdBuffer));
 
 		// Submit
-		// Semaphore wait image available before output color
-		VkSemaphoreSubmitInfo waitInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
-		waitInfo.semaphore = frame->GetImageAcquireSemaphore();
-		waitInfo.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+		// Semaphore wait image available before output color (no image headless), compute results before their first consumer stage
+		std::array<VkSemaphoreSubmitInfo, 2> waitInfos = {};
+		uint32_t waitCount = 0;
+		if (!headless)
+		{
+			waitInfos[waitCount].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+			waitInfos[waitCount].semaphore = frame->GetImageAcquireSemaphore();
+			waitInfos[waitCount].stageMask = ACQUIRE_WAIT_STAGES;
+			++waitCount;
+		}
+		if (AsyncCompute::ConsumeGraphicsWait(waitInfos[waitCount]))
+		{
+			++waitCount;
+		}
+
+		// Signals after all graphics commands done: frame number on the timeline, binary one for present
+		std::array<VkSemaphoreSubmitInfo, 2> signalInfos = {};
+		signalInfos[0].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+		signalInfos[0].semaphore = VulkanCore::GetFrameTimeline();
+		signalInfos[0].value = VulkanCore::GetFrameNumber();
+		signalInfos[0].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
 
-		// Semaphore signal after all graphics commands done
-		VkSemaphoreSubmitInfo signalInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
-		signalInfo.semaphore = frame->GetGlobalRenderSemaphores()[m_CurrentImageIndex];
-		signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT;
+		if (!headless)
+		{
+			signalInfos[1].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+			signalInfos[1].semaphore = VulkanCore::GetSwapchain()->GetRenderSemaphore(m_CurrentImageIndex);
+			signalInfos[1].stageMask = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT;
+		}
 
 		VkCommandBufferSubmitInfo cmdInfo = {};
 		cmdInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
 		cmdInfo.commandBuffer = cmdBuffer;
 
 		VkSubmitInfo2 submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
-		submitInfo.waitSemaphoreInfoCount = 1;
-		submitInfo.pWaitSemaphoreInfos = &waitInfo;
-		submitInfo.signalSemaphoreInfoCount = 1;
-		submitInfo.pSignalSemaphoreInfos = &signalInfo;
+		submitInfo.waitSemaphoreInfoCount = waitCount;
+		submitInfo.pWaitSemaphoreInfos = waitInfos.data();
+		submitInfo.signalSemaphoreInfoCount = headless ? 1 : 2;
+		submitInfo.pSignalSemaphoreInfos = signalInfos.data();
 		submitInfo.commandBufferInfoCount = 1;
 		submitInfo.pCommandBufferInfos = &cmdInfo;
-		CHECK_VK_RES(vkQueueSubmit2(graphicsQueue, 1, &submitInfo, frame->GetRenderFence()));
+		CHECK_VK_RES(vkQueueSubmit2(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+		// The submit signals this frame's timeline value: advance right away, whatever the present
+		// returns, so the next frame signals a strictly greater value and present ids stay unique
+		const uint64_t frameNumber = VulkanCore::GetFrameNumber();
+		VulkanCore::AdvanceFrame();
+
+		if (!headless)
+		{
+			Present(signalInfos[1].semaphore, frameNumber);
+		}
+	}
+
+	void VulkanRenderer::Present(VkSemaphore renderSemaphore, uint64_t presentId)
+	{
+		auto	presentQueue	= VulkanCore::GetPresentQueue();
+		auto	rawSwapchain	= VulkanCore::GetSwapchain()->GetRaw();
+
+		// Present, tagged with the frame number when the low-latency mode waits on it
+		VkPresentIdKHR presentIdInfo = { VK_STRUCTURE_TYPE_PRESENT_ID_KHR };
+		presentIdInfo.swapchainCount = 1;
+		presentIdInfo.pPresentIds = &presentId;
+		const bool usePresentWait = VulkanCore::GetSettings().lowLatency && VulkanCore::GetCapabilities().presentWait;
 
-		// Present
 		VkPresentInfoKHR presentInfo = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+		presentInfo.pNext = usePresentWait ? &presentIdInfo : nullptr;
+
+		// Signaled once the present no longer uses the render semaphore, so a retired swapchain can go
+		VkFence presentFence = VulkanCore::GetSwapchain()->AcquirePresentFence();
+		VkSwapchainPresentFenceInfoEXT presentFenceInfo = { VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT };
+		if (presentFence != VK_NULL_HANDLE)
+		{
+			presentFenceInfo.pNext = presentInfo.pNext;
+			presentFenceInfo.swapchainCount = 1;
+			presentFenceInfo.pFences = &presentFence;
+			presentInfo.pNext = &presentFenceInfo;
+		}
 		presentInfo.swapchainCount = 1;
 		presentInfo.pSwapchains = &rawSwapchain;
 		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores = &signalInfo.semaphore;
+		presentInfo.pWaitSemaphores = &renderSemaphore;
 		presentInfo.pImageIndices = &m_CurrentImageIndex;
-		if (vkQueuePresentKHR(presentQueue, &presentInfo) == VK_ERROR_OUT_OF_DATE_KHR)
+		const VkResult presentResult = vkQueuePresentKHR(presentQueue, &presentInfo);
+		if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR)
 		{
 			m_InvalidSwapchain = true;
-			return;
+		}
+		else
+		{
+			CHECK_VK_RES(presentResult);
 		}
 
-		VulkanCore::AdvanceFrame();
+		if (presentResult != VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			m_LastPresentId = presentId;
+			m_LastPresentSwapchain = rawSwapchain;
+		}
 	}
 
-	void VulkanRenderer::CopyRenderTargetToSwapchain()
+	void VulkanRenderer::BuildRenderGraph()
 	{
-		auto  cmdBuffer  = VulkanCore::GetCurrentFrame()->GetCmdBuffer();
-		auto  swImage	 = VulkanCore::GetSwapchain()->GetImages()[m_CurrentImageIndex];
-		auto  rt		 = VulkanCore::GetRenderTarget();
-
-		// Prepare rt for transfer src
-		Synchronization::CmdImageMemoryBarrier(cmdBuffer, rt,
-			VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-			VK_ACCESS_2_TRANSFER_READ_BIT,
-			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-			VK_IMAGE_ASPECT_COLOR_BIT
-		);
+		const auto& rt = m_Resolution.GetRenderTarget();
+		const VkExtent2D renderExtent = m_Resolution.GetRenderExtent();
 
-		// Prepare swapchain image for transfer dst
-		Synchronization::CmdImageMemoryBarrier(cmdBuffer, swImage,
-			VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-			VK_ACCESS_2_TRANSFER_WRITE_BIT,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			VK_IMAGE_ASPECT_COLOR_BIT
-		);
+		m_RenderGraph.Reset();
+
+		// Headless: the frame ends in the render target, left readable for SaveRenderTarget
+		if (VulkanCore::IsHeadless())
+		{
+			const auto color = m_RenderGraph.ImportImage("RenderTarget", rt);
+			const auto depth = m_RenderGraph.CreateImage("Depth", TransientImageDesc{ .format = VK_FORMAT_D32_SFLOAT, .extent = rt->GetExtent() });
+			m_RenderGraph.SetOutput(color, ImageUsage::TRANSFER_SRC);
+			AddScenePass(color, depth, renderExtent);
+			m_RenderGraph.Compile();
+			return;
+		}
+
+		const auto& swImage = VulkanCore::GetSwapchain()->GetImages()[m_CurrentImageIndex];
+
+		// The presentation engine may still read the image until the acquire semaphore signals:
+		// its first transition has to start from the stages waiting on that semaphore
+		swImage->SetSyncState(ACQUIRE_WAIT_STAGES, VK_ACCESS_2_NONE, swImage->GetSyncState().lastLayout);
 
-		// Copy rt to swapchain image
-		ImageOperations::CmdBlit(cmdBuffer, rt, swImage, rt->GetExtent(), swImage->GetExtent());
+		// Direct mode: the scene renders into the backbuffer, there's nothing to copy
+		const bool direct = VulkanCore::GetSettings().directToSwapchain;
+		const VkExtent3D targetExtent = direct ? swImage->GetExtent() : rt->GetExtent();
+
+		const auto backbuffer = m_RenderGraph.ImportImage("Swapchain", swImage);
+		const auto color = direct ? backbuffer : m_RenderGraph.ImportImage("RenderTarget", rt);
+		const auto depth = m_RenderGraph.CreateImage("Depth", TransientImageDesc{ .format = VK_FORMAT_D32_SFLOAT, .extent = targetExtent });
+		m_RenderGraph.SetOutput(backbuffer, ImageUsage::PRESENT);
+
+		AddScenePass(color, depth, renderExtent);
+
+		if (!direct)
+		{
+			m_RenderGraph.AddPass("CopyToSwapchain",
+				[color, backbuffer](RenderGraph::PassBuilder& pass)
+				{
+					pass.Read(color, ImageUsage::TRANSFER_SRC)
+						.Write(backbuffer, ImageUsage::TRANSFER_DST);
+				},
+				[color, backbuffer, renderExtent](VkCommandBuffer cmdBuffer, const RenderGraph& graph)
+				{
+					// Upscales the rendered region to the whole swapchain image
+					const auto& dst = graph.GetImage(backbuffer);
+					ImageOperations::CmdBlit(cmdBuffer, *graph.GetImage(color), *dst, VkExtent3D{ renderExtent.width, renderExtent.height, 1 }, dst->GetExtent());
+				});
+		}
+
+		m_RenderGraph.AddPass("ImGui",
+			[backbuffer](RenderGraph::PassBuilder& pass)
+			{
+				pass.Write(backbuffer, ImageUsage::COLOR_ATTACHMENT);
+			},
+			[this, backbuffer](VkCommandBuffer cmdBuffer, const RenderGraph& graph)
+			{
+				m_ImGuiRenderer->DrawImGui(cmdBuffer, *graph.GetImage(backbuffer));
+			});
+
+		m_RenderGraph.Compile();
 	}
 
-	void VulkanRenderer::DrawImGuiToSwapchain()
+	void VulkanRenderer::AddScenePass(RenderGraphResource color, RenderGraphResource depth, VkExtent2D renderExtent)
 	{
-		auto swapchainImage = VulkanCore::GetSwapchain()->GetImages()[m_CurrentImageIndex];
-
-		m_ImGuiRenderer->DrawImGui(swapchainImage);
+		m_RenderGraph.AddPass("Scene",
+			[color, depth](RenderGraph::PassBuilder& pass)
+			{
+				pass.Write(color, ImageUsage::COLOR_ATTACHMENT)
+					.Write(depth, ImageUsage::DEPTH_ATTACHMENT);
+			},
+			[this, color, depth, renderExtent](VkCommandBuffer cmdBuffer, const RenderGraph& graph)
+			{
+				m_Scene->Render(cmdBuffer, *graph.GetImage(color), *graph.GetImage(depth), renderExtent);
+			});
 	}
 
 }
\ No newline at end of file
@@ -3,7 +3,11 @@
 #include "Scene.h"
 #include "Window.h"
 #include "VulkanFrame.h"
+#include "RenderGraph.h"
+#include "ResolutionManager.h"
 #include "ImGui/ImGuiRenderer.h"
+#include <chrono>
+#include <filesystem>
 #include <memory>
 #include <vector>
 
@@ -12,6 +16,7 @@ namespace tiny_vulkan {
 	class VulkanRenderer
 	{
 	public:
+		// Null window: headless, frames end in the render target (VulkanCore::InitializeHeadless)
 		explicit VulkanRenderer(std::shared_ptr<Window> window);
 		~VulkanRenderer() = default;
 
@@ -20,18 +25,48 @@ namespace tiny_vulkan {
 
 		void Draw();
 
+		// Low-latency mode: blocks until the previous frame reached the display, call before sampling input.
+		// Does nothing otherwise.
+		void WaitForPresent();
+
+		// Writes the last rendered frame (render extent, 8-bit clamped) as a PPM image.
+		// Blocks until the GPU is idle: for captures and CI image diffs, typically headless.
+		bool SaveRenderTarget(const std::filesystem::path& path);
+
+		// Logs creation latency and bind cost of the scene material per pipeline backend (PipelineBenchmark).
+		void BenchmarkPipelines();
+
 	private:
-		void BeginFrame();
+		// False when no frame can be recorded (minimized window, out of date swapchain)
+		[[nodiscard]] bool BeginFrame();
 		void EndFrame();
-		void CopyRenderTargetToSwapchain();
-		void DrawImGuiToSwapchain();
+		void Present(VkSemaphore renderSemaphore, uint64_t presentId);	// presentId: number of the submitted frame
+		[[nodiscard]] bool AcquireSwapchainImage();
+		[[nodiscard]] bool RecreateSwapchain();
+		void UpdateFrameStats();
+		void BuildRenderGraph();
+		void AddScenePass(RenderGraphResource color, RenderGraphResource depth, VkExtent2D renderExtent);
+
+		// Averages over the logging interval (RenderSettings::logFrameStats)
+		struct FrameStats
+		{
+			uint32_t								frameCount{ 0 };
+			double									gpuTimeMs{ 0.0 };
+			uint64_t								barrierCount{ 0 };
+			std::chrono::steady_clock::time_point	intervalStart{ std::chrono::steady_clock::now() };
+		};
 
 	private:
 		std::shared_ptr<Scene>			m_Scene;
 		std::shared_ptr<Window>			m_Window;
 		std::shared_ptr<ImGuiRenderer>	m_ImGuiRenderer;
+		RenderGraph						m_RenderGraph;
+		ResolutionManager				m_Resolution;
 		uint32_t						m_CurrentImageIndex{ 0 };
-		bool							m_InvalidSwapchain{ false };
+		uint64_t						m_LastPresentId{ 0 };		// Frame number of the last present, 0 if none
+		VkSwapchainKHR					m_LastPresentSwapchain{ VK_NULL_HANDLE };
+		bool							m_InvalidSwapchain{ false };	// Rebuilt at the next frame boundary
+		FrameStats						m_FrameStats;
 	};
 
 }
\ No newline at end of file
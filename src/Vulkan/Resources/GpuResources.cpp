@@ -0,0 +1,56 @@
+#include "GpuResources.h"
+#include "LifetimeManager.h"
+#include "LogSystem.h"
+
+namespace tiny_vulkan::GpuResources {
+
+	namespace {
+		// Internal linkage: accessible only within this translation unit.
+		ResourcePool<VulkanBuffer> g_Buffers;
+		bool g_CleanupRegistered = false;
+
+		// Whatever is still pooled at shutdown is released while the device is alive
+		void RegisterCleanup()
+		{
+			if (g_CleanupRegistered)
+			{
+				return;
+			}
+			g_CleanupRegistered = true;
+
+			LifetimeManager::PushFunction([]()
+				{
+					if (g_Buffers.GetAliveCount() > 0)
+					{
+						LOG_DEBUG(fmt::runtime("Releasing {} pooled buffers at shutdown"), g_Buffers.GetAliveCount());
+					}
+					g_Buffers.Clear();
+				});
+		}
+	}
+
+	BufferHandle AddBuffer(VulkanBuffer&& buffer)
+	{
+		RegisterCleanup();
+		return g_Buffers.Create(std::move(buffer));
+	}
+
+	VulkanBuffer* GetBuffer(BufferHandle handle)
+	{
+		return g_Buffers.Get(handle);
+	}
+
+	void ReleaseBuffer(BufferHandle handle)
+	{
+		if (handle.IsValid() && !g_Buffers.Release(handle))
+		{
+			LOG_WARN(fmt::runtime("Releasing a stale buffer handle (slot {0}, generation {1})"), handle.index, handle.generation);
+		}
+	}
+
+	size_t GetBufferCount()
+	{
+		return g_Buffers.GetAliveCount();
+	}
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "VulkanBuffer.h"
+#include "ResourcePool.h"
+
+// Pooled GPU resources referenced by generation-checked handles instead of shared_ptr:
+// no refcount traffic on the draw path, and a handle to a released resource is detected.
+// Render thread only.
+namespace tiny_vulkan::GpuResources {
+
+	[[nodiscard]] BufferHandle AddBuffer(VulkanBuffer&& buffer);
+
+	// nullptr when the handle is stale.
+	[[nodiscard]] VulkanBuffer* GetBuffer(BufferHandle handle);
+
+	// The buffer goes through the deletion queue, the handle (and its copies) turns stale right away.
+	void ReleaseBuffer(BufferHandle handle);
+
+	[[nodiscard]] size_t GetBufferCount();
+
+}
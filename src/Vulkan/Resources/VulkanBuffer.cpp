@@ -1,17 +1,97 @@
 #include "VulkanBuffer.h"
 #include "VulkanCore.h"
-#include "LifetimeManager.h"
+#include "GpuResources.h"
+#include "DeletionQueue.h"
 
 namespace tiny_vulkan {
 
-	VulkanBuffer::VulkanBuffer(VkBuffer buffer, VmaAllocation allocation, VmaAllocationInfo allocationInfo)
+	VulkanBuffer::VulkanBuffer(VkBuffer buffer, VmaAllocation allocation, VmaAllocationInfo allocationInfo, VkDeviceSize size)
 		: m_Buffer(buffer)
 		, m_Allocation(allocation)
 		, m_VmaAllocationInfo(allocationInfo)
+		, m_Size(size)
+		, m_SyncStates{ BufferRangeState{ .offset = 0, .size = size } }
 	{
 
 	}
 
+	VulkanBuffer::VulkanBuffer(VulkanBuffer&& other) noexcept
+		: m_Buffer(std::exchange(other.m_Buffer, VK_NULL_HANDLE))
+		, m_Allocation(std::exchange(other.m_Allocation, VK_NULL_HANDLE))
+		, m_VmaAllocationInfo(other.m_VmaAllocationInfo)
+		, m_Size(other.m_Size)
+		, m_SyncStates(std::move(other.m_SyncStates))
+	{
+
+	}
+
+	VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& other) noexcept
+	{
+		if (this != &other)
+		{
+			std::swap(m_Buffer, other.m_Buffer);
+			std::swap(m_Allocation, other.m_Allocation);
+			std::swap(m_VmaAllocationInfo, other.m_VmaAllocationInfo);
+			std::swap(m_Size, other.m_Size);
+			std::swap(m_SyncStates, other.m_SyncStates);
+		}
+		return *this;
+	}
+
+	void VulkanBuffer::SetSyncState(VkDeviceSize offset, VkDeviceSize size, const BufferSyncState& state)
+	{
+		if (offset >= m_Size)
+		{
+			return;
+		}
+		const VkDeviceSize end = size == VK_WHOLE_SIZE || size > m_Size - offset ? m_Size : offset + size;
+		if (offset == end)
+		{
+			return;
+		}
+
+		std::vector<BufferRangeState> ranges;
+		ranges.reserve(m_SyncStates.size() + 2);
+
+		auto append = [&ranges](VkDeviceSize begin, VkDeviceSize rangeEnd, const BufferSyncState& rangeState)
+			{
+				if (begin >= rangeEnd)
+				{
+					return;
+				}
+				if (!ranges.empty() && ranges.back().state == rangeState)
+				{
+					ranges.back().size += rangeEnd - begin;
+					return;
+				}
+				ranges.push_back(BufferRangeState{ .offset = begin, .size = rangeEnd - begin, .state = rangeState });
+			};
+
+		// Keep what lies outside [offset, end), the new state replaces the inside
+		bool inserted = false;
+		for (const auto& range : m_SyncStates)
+		{
+			const VkDeviceSize rangeEnd = range.offset + range.size;
+			append(range.offset, std::min(rangeEnd, offset), range.state);
+			if (!inserted && rangeEnd > offset)
+			{
+				append(offset, end, state);
+				inserted = true;
+			}
+			append(std::max(range.offset, end), rangeEnd, range.state);
+		}
+
+		m_SyncStates = std::move(ranges);
+	}
+
+	VulkanBuffer::~VulkanBuffer()
+	{
+		if (m_Buffer != VK_NULL_HANDLE)
+		{
+			DeletionQueue::PushFunction(vmaDestroyBuffer, VulkanCore::GetVmaAllocator(), m_Buffer, m_Allocation);
+		}
+	}
+
 	VulkanBufferBuilder& VulkanBufferBuilder::SetAllocationSize(size_t allocSize)
 	{
 		m_AllocSize = allocSize;
@@ -30,7 +110,30 @@ namespace tiny_vulkan {
 		return *this;
 	}
 
+	VulkanBufferBuilder& VulkanBufferBuilder::SetQueueFamilies(const std::vector<uint32_t>& families)
+	{
+		m_QueueFamilies.clear();
+		for (uint32_t family : families)
+		{
+			if (std::ranges::find(m_QueueFamilies, family) == m_QueueFamilies.end())
+			{
+				m_QueueFamilies.push_back(family);
+			}
+		}
+		return *this;
+	}
+
 	std::shared_ptr<VulkanBuffer> VulkanBufferBuilder::Build()
+	{
+		return std::make_shared<VulkanBuffer>(Create());
+	}
+
+	BufferHandle VulkanBufferBuilder::BuildHandle()
+	{
+		return GpuResources::AddBuffer(Create());
+	}
+
+	VulkanBuffer VulkanBufferBuilder::Create() const
 	{
 		VkBufferCreateInfo bufferInfo = {};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -41,11 +144,19 @@ namespace tiny_vulkan {
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		bufferInfo.queueFamilyIndexCount = 0;
 		bufferInfo.pQueueFamilyIndices = nullptr;
+		if (m_QueueFamilies.size() > 1)
+		{
+			bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			bufferInfo.queueFamilyIndexCount = (uint32_t)m_QueueFamilies.size();
+			bufferInfo.pQueueFamilyIndices = m_QueueFamilies.data();
+		}
 
 		VmaAllocationCreateInfo allocCreateInfo = {};
 		allocCreateInfo.usage = m_MemoryUsagePlace;
 
-		if (m_MemoryUsagePlace == VMA_MEMORY_USAGE_CPU_TO_GPU || m_MemoryUsagePlace == VMA_MEMORY_USAGE_CPU_ONLY) 
+		if (m_MemoryUsagePlace == VMA_MEMORY_USAGE_CPU_TO_GPU ||
+			m_MemoryUsagePlace == VMA_MEMORY_USAGE_CPU_ONLY ||
+			m_MemoryUsagePlace == VMA_MEMORY_USAGE_GPU_TO_CPU)
 		{
 			allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 		}
@@ -57,7 +168,7 @@ namespace tiny_vulkan {
 
 		CHECK_VK_RES(vmaCreateBuffer(allocator, &bufferInfo, &allocCreateInfo, &buffer, &allocation, &allocationInfo));
 
-		return std::make_shared<VulkanBuffer>(buffer, allocation, allocationInfo);
+		return VulkanBuffer(buffer, allocation, allocationInfo, bufferInfo.size);
 	}
 
 }
\ No newline at end of file
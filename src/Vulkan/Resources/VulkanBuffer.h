@@ -1,27 +1,64 @@
 #pragma once
 
+#include "ResourcePool.h"
+
 #include <memory>
+#include <vector>
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
 
 namespace tiny_vulkan {
 
+	struct BufferSyncState
+	{
+		VkPipelineStageFlags2	lastStage = VK_PIPELINE_STAGE_2_NONE;
+		VkAccessFlags2			lastAccess = VK_ACCESS_2_NONE;
+
+		bool operator==(const BufferSyncState&) const = default;
+	};
+
+	struct BufferRangeState
+	{
+		VkDeviceSize	offset{ 0 };
+		VkDeviceSize	size{ 0 };
+		BufferSyncState	state;
+	};
+
 	class VulkanBuffer
 	{
 	public:
-		explicit VulkanBuffer(VkBuffer buffer, VmaAllocation allocation, VmaAllocationInfo allocationInfo);
-		~VulkanBuffer() = default;
+		explicit VulkanBuffer(VkBuffer buffer, VmaAllocation allocation, VmaAllocationInfo allocationInfo, VkDeviceSize size);
+		~VulkanBuffer(); // Destroyed once the frames in flight are done with it
+
+		VulkanBuffer(const VulkanBuffer&) = delete;
+		VulkanBuffer& operator=(const VulkanBuffer&) = delete;
+
+		// Movable, so buffers can live by value in a ResourcePool
+		VulkanBuffer(VulkanBuffer&& other) noexcept;
+		VulkanBuffer& operator=(VulkanBuffer&& other) noexcept;
 
 		[[nodiscard]] VkBuffer			GetRaw()			const { return m_Buffer; }
 		[[nodiscard]] VmaAllocation		GetAllocation()		const { return m_Allocation; }
 		[[nodiscard]] VmaAllocationInfo GetAllocationInfo() const { return m_VmaAllocationInfo; }
+		// Size requested at creation, the allocation behind it may be larger
+		[[nodiscard]] VkDeviceSize		GetSize()			const { return m_Size; }
+
+		// Access state per byte range: sorted, contiguous, covering the whole buffer
+		[[nodiscard]] const std::vector<BufferRangeState>& GetSyncStates() const { return m_SyncStates; }
+
+		// Sets [offset, offset + size) to state, size may be VK_WHOLE_SIZE. Neighbours in the same state are merged.
+		void SetSyncState(VkDeviceSize offset, VkDeviceSize size, const BufferSyncState& state);
 
 	private:
-		VkBuffer			m_Buffer{ VK_NULL_HANDLE };
-		VmaAllocation		m_Allocation{ VK_NULL_HANDLE };
-		VmaAllocationInfo	m_VmaAllocationInfo{};
+		VkBuffer						m_Buffer{ VK_NULL_HANDLE };
+		VmaAllocation					m_Allocation{ VK_NULL_HANDLE };
+		VmaAllocationInfo				m_VmaAllocationInfo{};
+		VkDeviceSize					m_Size{ 0 };
+		std::vector<BufferRangeState>	m_SyncStates;
 	};
 
+	using BufferHandle = Handle<VulkanBuffer>;
+
 	class VulkanBufferBuilder
 	{
 	public:
@@ -31,12 +68,23 @@ namespace tiny_vulkan {
 		[[nodiscard]] VulkanBufferBuilder& SetAllocationSize(size_t allocSize);
 		[[nodiscard]] VulkanBufferBuilder& SetUsageMask(VkBufferUsageFlags usageMask);
 		[[nodiscard]] VulkanBufferBuilder& SetAllocationPlace(VmaMemoryUsage memoryUsagePlace);
+
+		// Used by the queues of these families without ownership transfers (VK_SHARING_MODE_CONCURRENT).
+		// Duplicates are ignored: a single family keeps the buffer exclusive.
+		[[nodiscard]] VulkanBufferBuilder& SetQueueFamilies(const std::vector<uint32_t>& families);
 		[[nodiscard]] std::shared_ptr<VulkanBuffer> Build();
 
+		// Same buffer, stored in the GpuResources pool
+		[[nodiscard]] BufferHandle BuildHandle();
+
 	private:
 		size_t				m_AllocSize{ 0 };
 		VkBufferUsageFlags	m_UsageMask{ VK_BUFFER_USAGE_TRANSFER_SRC_BIT };
 		VmaMemoryUsage		m_MemoryUsagePlace{ VMA_MEMORY_USAGE_UNKNOWN };
+		std::vector<uint32_t> m_QueueFamilies;
+
+	private:
+		[[nodiscard]] VulkanBuffer Create() const;
 	};
 
 }
\ No newline at end of file
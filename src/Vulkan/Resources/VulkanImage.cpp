@@ -2,12 +2,16 @@
 
 namespace tiny_vulkan {
 
-	VulkanImage::VulkanImage(VkImage image, VkImageView view, VkFormat format, VkExtent3D extent, VmaAllocation allocation)
+	VulkanImage::VulkanImage(VkImage image, VkImageView view, VkFormat format, VkExtent3D extent, VmaAllocation allocation,
+		uint32_t mipLevels, uint32_t arrayLayers)
 		: m_Image(image),
 		m_View(view),
 		m_Format(format),
 		m_Extent(extent),
-		m_Allocation(allocation)
+		m_Allocation(allocation),
+		m_MipLevels(mipLevels),
+		m_ArrayLayers(arrayLayers),
+		m_SyncStates(static_cast<size_t>(mipLevels) * arrayLayers)
 	{
 
 	}
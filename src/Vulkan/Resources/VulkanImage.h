@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+#include <cstdint>
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
 
@@ -10,12 +12,15 @@ namespace tiny_vulkan {
 		VkPipelineStageFlags2	lastStage = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
 		VkAccessFlags2			lastAccess = VK_ACCESS_2_NONE;
 		VkImageLayout			lastLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		bool operator==(const ImageSyncState&) const = default;
 	};
 
 	class VulkanImage
 	{
 	public:
-		explicit VulkanImage(VkImage image, VkImageView view, VkFormat format, VkExtent3D extent, VmaAllocation allocation);
+		explicit VulkanImage(VkImage image, VkImageView view, VkFormat format, VkExtent3D extent, VmaAllocation allocation,
+			uint32_t mipLevels = 1, uint32_t arrayLayers = 1);
 
 		VulkanImage(const VulkanImage&) = delete;
 		VulkanImage& operator=(const VulkanImage&) = delete;
@@ -25,12 +30,24 @@ namespace tiny_vulkan {
 		[[nodiscard]] VkFormat		GetFormat()		const { return m_Format; }
 		[[nodiscard]] VkExtent3D	GetExtent()		const { return m_Extent; }
 		[[nodiscard]] VmaAllocation	GetAllocation() const { return m_Allocation; }
+		[[nodiscard]] uint32_t		GetMipLevels()	const { return m_MipLevels; }
+		[[nodiscard]] uint32_t		GetArrayLayers() const { return m_ArrayLayers; }
 
-		[[nodiscard]] const ImageSyncState& GetSyncState() const { return m_SyncState; }
+		// State is tracked per subresource, so mips and layers can be transitioned independently
+		[[nodiscard]] const ImageSyncState& GetSyncState(uint32_t mip = 0, uint32_t layer = 0) const
+		{
+			return m_SyncStates[layer * m_MipLevels + mip];
+		}
 
+		inline void SetSyncState(uint32_t mip, uint32_t layer, const ImageSyncState& state)
+		{
+			m_SyncStates[layer * m_MipLevels + mip] = state;
+		}
+
+		// Whole image
 		inline void SetSyncState(VkPipelineStageFlags2 newStage, VkAccessFlags2 newAccess, VkImageLayout newLayout)
 		{
-			m_SyncState = { newStage, newAccess, newLayout };
+			m_SyncStates.assign(m_SyncStates.size(), ImageSyncState{ newStage, newAccess, newLayout });
 		}
 
 	private:
@@ -39,7 +56,10 @@ namespace tiny_vulkan {
 		VkFormat		m_Format{ VK_FORMAT_UNDEFINED };
 		VkExtent3D		m_Extent{ 0, 0, 0 };
 		VmaAllocation	m_Allocation{ VK_NULL_HANDLE };
-		ImageSyncState	m_SyncState;
+		uint32_t		m_MipLevels{ 1 };
+		uint32_t		m_ArrayLayers{ 1 };
+
+		std::vector<ImageSyncState>	m_SyncStates;	// Layer-major: layer * m_MipLevels + mip
 	};
 
 }
\ No newline at end of file
@@ -1,5 +1,4 @@
 #include "Window.h"
-#include "VulkanCore.h"
 #include "LifetimeManager.h"
 #include "LogSystem.h"
 
@@ -12,8 +11,11 @@ namespace tiny_vulkan {
 
 	static void FramebufferResizeCallback(GLFWwindow* window, int width, int height) // will be called when the size in pixels change
 	{
-		VulkanCore::GetSwapchain()->RecreateSwapchain(width, height);
-		LOG_INFO(fmt::runtime("Window resized to: {0}x{1}"), width, height);
+		// Fired for every intermediate size of a drag: only record it
+		auto* self = static_cast<Window*>(glfwGetWindowUserPointer(window));
+		self->SetWidth(width);
+		self->SetHeight(height);
+		self->MarkResized();
 	}
 
 	Window::Window(uint32_t width /*= 1280*/, uint32_t height /*= 720*/, const std::string& title /*= "Tiny Vulkan"*/)
@@ -40,6 +42,7 @@ namespace tiny_vulkan {
 		else
 		{
 			glfwSetErrorCallback(GLFWErrorCallback);
+			glfwSetWindowUserPointer(m_Window, this);
 			glfwSetFramebufferSizeCallback(m_Window, FramebufferResizeCallback);
 		}
 
@@ -54,6 +57,11 @@ namespace tiny_vulkan {
 
 	void Window::OnUpdate()
 	{
+		if (m_Width == 0 || m_Height == 0)
+		{
+			glfwWaitEvents();
+			return;
+		}
 		glfwPollEvents();
 	}
 
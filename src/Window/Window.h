@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cstdint>
+#include <utility>
 #include <GLFW/glfw3.h>
 
 namespace tiny_vulkan {
@@ -20,12 +21,18 @@ namespace tiny_vulkan {
 		void						SetHeight(int height)	{ m_Height = height; }
 		void						Update();
 
+		// Blocks on events while the framebuffer is empty (minimized), polls otherwise
 		void						OnUpdate();
 
+		// Resize events are only recorded, the renderer rebuilds the swapchain once at the next frame boundary
+		void						MarkResized()			{ m_Resized = true; }
+		[[nodiscard]] bool			ConsumeResize()			{ return std::exchange(m_Resized, false); }
+
 	private:
 		GLFWwindow* m_Window{ nullptr };
 		int m_Width{ 0 };
 		int m_Height{ 0 };
+		bool m_Resized{ false };
 	};
 
 }
\ No newline at end of file
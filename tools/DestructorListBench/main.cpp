@@ -0,0 +1,109 @@
+// tiny_destructor_list_bench: registration + release cost of DestructorList against std::vector<std::function>.
+// Usage: tiny_destructor_list_bench [entries = 100000] [runs = 20]
+// Entries are shaped like LifetimeManager::PushFunction(vkDestroyX, device, handle, nullptr).
+
+#include "DestructorList.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+	// Stand-ins for a device, a handle and vkDestroyX: cheap, but not optimized away
+	struct FakeDevice_T;
+	struct FakeHandle_T;
+	using FakeDevice = FakeDevice_T*;
+	using FakeHandle = FakeHandle_T*;
+
+	volatile uintptr_t g_Sink = 0;
+
+	void FakeDestroy(FakeDevice device, FakeHandle handle, const void* allocator)
+	{
+		g_Sink = g_Sink + reinterpret_cast<uintptr_t>(device) + reinterpret_cast<uintptr_t>(handle) + reinterpret_cast<uintptr_t>(allocator);
+	}
+
+	// Same capture as PushFunction: the function pointer and its arguments by value
+	auto MakeDeleter(size_t i)
+	{
+		auto* function = &FakeDestroy;
+		auto device = reinterpret_cast<FakeDevice>(uintptr_t(0x1000));
+		auto handle = reinterpret_cast<FakeHandle>(uintptr_t(i + 1));
+		const void* allocator = nullptr;
+		return [function, device, handle, allocator]() { function(device, handle, allocator); };
+	}
+
+	double BenchFunctionVector(size_t count)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::function<void()>> deleters;
+		for (size_t i = 0; i < count; ++i)
+		{
+			deleters.emplace_back(MakeDeleter(i));
+		}
+		for (auto it = deleters.rbegin(); it != deleters.rend(); ++it)
+		{
+			(*it)();
+		}
+		deleters.clear();
+
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	double BenchDestructorList(size_t count)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		tiny_vulkan::DestructorList deleters;
+		for (size_t i = 0; i < count; ++i)
+		{
+			deleters.Push(MakeDeleter(i));
+		}
+		deleters.ExecuteAll();
+
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	struct Result
+	{
+		double min{ 0.0 };
+		double median{ 0.0 };
+	};
+
+	template<typename F>
+	Result Measure(F&& bench, size_t count, int runs)
+	{
+		bench(count); // Warm up the allocator
+
+		std::vector<double> times;
+		for (int i = 0; i < runs; ++i)
+		{
+			times.push_back(bench(count));
+		}
+		std::ranges::sort(times);
+		return Result{ times.front(), times[times.size() / 2] };
+	}
+
+}
+
+int main(int argc, char** argv)
+{
+	const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+	const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+	std::cout << "sizeof(capture) = " << sizeof(MakeDeleter(0)) << " bytes, std::function = " << sizeof(std::function<void()>) << " bytes\n";
+	std::cout << count << " registrations + release, " << runs << " runs (min / median):\n";
+
+	const Result functions = Measure(BenchFunctionVector, count, runs);
+	const Result list = Measure(BenchDestructorList, count, runs);
+
+	std::cout << "  std::vector<std::function>: " << functions.min << " / " << functions.median << " ms\n";
+	std::cout << "  DestructorList:             " << list.min << " / " << list.median << " ms\n";
+	std::cout << "  speedup (median):           " << functions.median / list.median << "x\n";
+	return 0;
+}
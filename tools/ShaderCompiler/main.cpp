@@ -0,0 +1,126 @@
+// tiny_shader_compiler: precompiles GLSL shaders to versioned SPIR-V at build time.
+// Usage: tiny_shader_compiler <output dir> <shader>...
+// Writes "<name>-<key>.spv" per shader plus a manifest VulkanShader reads at runtime.
+
+#include "ShaderCompiler.h"
+#include "Hash.h"
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <set>
+
+namespace {
+
+	std::optional<std::string> ReadText(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+		{
+			return std::nullopt;
+		}
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	bool WriteBinary(const std::filesystem::path& path, const std::vector<uint32_t>& spirv)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+		return static_cast<bool>(file);
+	}
+
+}
+
+int main(int argc, char** argv)
+{
+	using namespace tiny_vulkan;
+
+	if (argc < 2)
+	{
+		std::cerr << "Usage: tiny_shader_compiler <output dir> <shader>...\n";
+		return 1;
+	}
+
+	const std::filesystem::path outputDir = argv[1];
+	std::filesystem::create_directories(outputDir);
+
+	ShaderCompiler::Manifest manifest;
+	std::set<std::string> binaries;
+	bool failed = false;
+
+	for (int i = 2; i < argc; ++i)
+	{
+		const std::filesystem::path path = argv[i];
+		const std::string name = path.filename().string();
+
+		if (manifest.contains(name))
+		{
+			std::cerr << "Duplicate shader file name, " << path.string() << " is skipped\n";
+			continue;
+		}
+
+		auto rawSource = ReadText(path);
+		if (!rawSource)
+		{
+			std::cerr << "Failed to open shader: " << path.string() << '\n';
+			failed = true;
+			continue;
+		}
+
+		std::string source;
+		std::string error;
+		std::vector<std::filesystem::path> dependencies;
+		std::vector<uint32_t> spirv;
+		if (!ShaderCompiler::Preprocess(path, *rawSource, {}, source, dependencies, error) ||
+			!ShaderCompiler::Compile(path, source, spirv, error))
+		{
+			std::cerr << error << '\n';
+			failed = true;
+			continue;
+		}
+
+		const std::string binaryName = ShaderCompiler::GetBinaryName(path, ShaderCompiler::ComputeCacheKey(path, source));
+		if (!WriteBinary(outputDir / binaryName, spirv))
+		{
+			std::cerr << "Failed to write " << binaryName << '\n';
+			failed = true;
+			continue;
+		}
+
+		ShaderCompiler::ManifestEntry entry{ .sourceHash = Hash::String(*rawSource), .binaryName = binaryName };
+		for (const auto& dependency : dependencies)
+		{
+			// Included files invalidate the binary the same way the source does. Stored relative to the shader,
+			// so the runtime resolves them next to the shader it loads, as its own includes would be
+			auto content = ReadText(dependency);
+			entry.dependencies.push_back(ShaderCompiler::ManifestDependency{
+				.path = dependency.lexically_relative(ShaderCompiler::CanonicalPath(path).parent_path()).generic_string(),
+				.hash = content ? Hash::String(*content) : 0
+				});
+		}
+
+		manifest[name] = std::move(entry);
+		binaries.insert(binaryName);
+		std::cout << name << " -> " << binaryName << '\n';
+	}
+
+	// Drop binaries of previous builds
+	for (const auto& entry : std::filesystem::directory_iterator(outputDir))
+	{
+		if (entry.path().extension() == ".spv" && !binaries.contains(entry.path().filename().string()))
+		{
+			std::filesystem::remove(entry.path());
+		}
+	}
+
+	if (failed || !ShaderCompiler::WriteManifest(outputDir / ShaderCompiler::MANIFEST_NAME, manifest))
+	{
+		return 1;
+	}
+
+	return 0;
+}